@@ -0,0 +1,78 @@
+/****************************************************************************
+  FileName     [ genAag.cpp ]
+  PackageName  [ cir/bench ]
+  Synopsis     [ Generate large random AAG files for the benchmarks ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "rnGen.h"
+
+using namespace std;
+
+static RandomNumGen* rnGen = 0;
+
+// 0 .. n-1 (RandomNumGen gives n itself once in 2^31 times)
+static unsigned
+pick(unsigned n)
+{
+   unsigned r = (*rnGen)(n);
+   return (r < n? r: n - 1);
+}
+
+// genAag <ands> [<inputs> [<seed>]] > file.aag
+//
+// A combinational AIG of <ands> AND gates over <inputs> PIs (default
+// <ands>/20). One fanin of each AND is a gate of the last 1024 ones, the
+// other any gate before it, both inverted at random; one AND in 1000
+// repeats the fanins of an earlier one, swapped, so that strash has
+// something to merge. Every AND that is not a fanin is a PO, so all the
+// gates are in the DFS list. The same arguments give the same file.
+//
+int
+main(int argc, char** argv)
+{
+   if(argc < 2 || argc > 4) {
+      cerr << "Usage: genAag <ands> [<inputs> [<seed>]] > file.aag" << endl;
+      return 1;
+   }
+   unsigned A = atoi(argv[1]);
+   unsigned I = (argc > 2? atoi(argv[2]): A / 20);
+   unsigned seed = (argc > 3? atoi(argv[3]): 1);
+   if(I == 0)   I = 1;
+   RandomNumGen gen(seed);
+   rnGen = &gen;
+
+   // the variables of the ANDs are I+1 .. I+A
+   vector<unsigned> fanin(2*A);
+   vector<bool> used(I + A + 1, false);
+   for(unsigned i=0; i<A; i++) {
+      unsigned var = I + 1 + i, a, b;
+      if(i > 0 && pick(1000) == 0) {
+         unsigned j = pick(i);
+         a = fanin[2*j+1];   b = fanin[2*j];
+      }
+      else {
+         unsigned near = (var - 1 < 1024? var - 1: 1024);
+         a = (var - 1 - pick(near)) * 2 + pick(2);
+         b = (1 + pick(var - 1)) * 2 + pick(2);
+      }
+      fanin[2*i] = a;   fanin[2*i+1] = b;
+      used[a/2] = used[b/2] = true;
+   }
+   vector<unsigned> outputs;
+   for(unsigned i=0; i<A; i++)
+      if(!used[I + 1 + i])   outputs.push_back((I + 1 + i) * 2);
+
+   cout << "aag " << I + A << " " << I << " 0 " << outputs.size() << " "
+        << A << "\n";
+   for(unsigned i=1; i<=I; i++)   cout << i*2 << "\n";
+   for(size_t i=0; i<outputs.size(); i++)   cout << outputs[i] << "\n";
+   for(unsigned i=0; i<A; i++)
+      cout << (I + 1 + i) * 2 << " " << fanin[2*i] << " " << fanin[2*i+1] << "\n";
+   cout << "c\ngenAag " << A << " " << I << " " << seed << endl;
+   return 0;
+}
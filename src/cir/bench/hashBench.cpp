@@ -0,0 +1,173 @@
+/****************************************************************************
+  FileName     [ hashBench.cpp ]
+  PackageName  [ cir/bench ]
+  Synopsis     [ Time HashSet against std::tr1::unordered_set and HashMap ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <sys/time.h>
+#include <tr1/unordered_set>
+#include "myHashSet.h"
+#include "myHashMap.h"
+#include "rnGen.h"
+
+using namespace std;
+
+// hashBench [-n <runs>] <keys>...
+//
+// For each number of keys, <runs> times (default 3): inserts that many
+// random keys into a new HashSet, std::tr1::unordered_set and HashMap
+// (with a dummy data, the way the code used it for a set), each made
+// for that many keys, then looks each key up (hits), as many other keys
+// (misses), and removes the keys. It reports the shortest wall-clock
+// time of each, in ns per key. The keys are the same for all of them.
+//
+
+static double
+wallTime()
+{
+   timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1e6;
+}
+
+// a 64-bit key, like the literal pairs of strash
+class BenchKey
+{
+public:
+   BenchKey(unsigned long long k = 0): _k(k) {}
+
+   size_t operator() () const { return (size_t)_k; }
+   bool operator == (const BenchKey& k) const { return (_k == k._k); }
+
+private:
+   unsigned long long _k;
+};
+
+class BenchKeyHash
+{
+public:
+   size_t operator() (const BenchKey& k) const { return k(); }
+};
+
+// the same operations on the three of them
+class FlatSet
+{
+public:
+   FlatSet(size_t n): _set(n) {}
+   void insert(const BenchKey& k) { _set.insert(k); }
+   bool check(const BenchKey& k) const { return _set.check(k); }
+   void remove(const BenchKey& k) { _set.remove(k); }
+   size_t size() const { return _set.size(); }
+private:
+   HashSet<BenchKey> _set;
+};
+
+class StdSet
+{
+public:
+   StdSet(size_t n): _set(n) {}
+   void insert(const BenchKey& k) { _set.insert(k); }
+   bool check(const BenchKey& k) const { return _set.count(k); }
+   void remove(const BenchKey& k) { _set.erase(k); }
+   size_t size() const { return _set.size(); }
+private:
+   tr1::unordered_set<BenchKey, BenchKeyHash> _set;
+};
+
+class MapSet
+{
+public:
+   MapSet(size_t n): _map(n) {}
+   void insert(const BenchKey& k) { _map.insert(k, true); }
+   bool check(const BenchKey& k) const { return _map.check(k); }
+   void remove(const BenchKey& k) { _map.remove(k); }
+   size_t size() const { return _map.size(); }
+private:
+   HashMap<BenchKey, bool> _map;
+};
+
+// insert, hit, miss and remove, best of "runs" each
+template <class Set>
+static bool
+timeSet(const vector<BenchKey>& keys, const vector<BenchKey>& others,
+        int runs, double best[4])
+{
+   size_t n = keys.size();
+   bool ok = true;
+   for(int r=0; r<runs; r++) {
+      double t[5];
+      size_t hits = 0, misses = 0;
+      Set* s = new Set(n);
+      t[0] = wallTime();
+      for(size_t i=0; i<n; i++)   s->insert(keys[i]);
+      t[1] = wallTime();
+      for(size_t i=0; i<n; i++)   hits += s->check(keys[i]);
+      t[2] = wallTime();
+      for(size_t i=0; i<n; i++)   misses += s->check(others[i]);
+      t[3] = wallTime();
+      for(size_t i=0; i<n; i++)   s->remove(keys[i]);
+      t[4] = wallTime();
+      ok = ok && hits == n && misses == 0 && s->size() == 0;
+      delete s;
+      for(int j=0; j<4; j++)
+         if(r == 0 || t[j+1] - t[j] < best[j])   best[j] = t[j+1] - t[j];
+   }
+   return ok;
+}
+
+int
+main(int argc, char** argv)
+{
+   int runs = 3, i = 1;
+   if(argc > 2 && string(argv[1]) == "-n") {
+      runs = atoi(argv[2]);
+      i = 3;
+   }
+   if(i >= argc || runs <= 0) {
+      cerr << "Usage: hashBench [-n <runs>] <keys>..." << endl;
+      return 1;
+   }
+   for(; i<argc; i++) {
+      size_t n = atoi(argv[i]);
+      if(n == 0) {
+         cerr << argv[i] << ": not a number of keys!!" << endl;
+         return 1;
+      }
+      // distinct keys: the low half of the bits count them, the high
+      // half is random; the others are the keys with the top bit set
+      RandomNumGen rnGen(1);
+      vector<BenchKey> keys, others;
+      keys.reserve(n);   others.reserve(n);
+      for(size_t j=0; j<n; j++) {
+         unsigned long long r = (unsigned)rnGen(1 << 30);
+         unsigned long long k = (r << 32) | j;
+         keys.push_back(k);
+         others.push_back(k | (1ULL << 63));
+      }
+      const char* names[] = { "HashSet", "unordered_set", "HashMap" };
+      double best[3][4];
+      bool ok = timeSet<FlatSet>(keys, others, runs, best[0])
+             && timeSet<StdSet>(keys, others, runs, best[1])
+             && timeSet<MapSet>(keys, others, runs, best[2]);
+      if(!ok) {
+         cerr << argv[i] << ": a set lost or made up a key!!" << endl;
+         return 1;
+      }
+      cout << n << " keys (ns per key, best of " << runs << "):" << endl;
+      for(int j=0; j<3; j++)
+         cout << "  " << setw(14) << left << names[j] << fixed
+              << setprecision(1) << right
+              << " insert " << setw(6) << best[j][0] * 1e9 / n
+              << "  hit " << setw(6) << best[j][1] * 1e9 / n
+              << "  miss " << setw(6) << best[j][2] * 1e9 / n
+              << "  remove " << setw(6) << best[j][3] * 1e9 / n << endl;
+   }
+   return 0;
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+  FileName     [ readBench.cpp ]
+  PackageName  [ cir/bench ]
+  Synopsis     [ Time CirMgr::readCircuit() on large files ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "cirMgr.h"
+
+using namespace std;
+
+// readBench [-n <runs>] <file>...
+//
+// Reads each file <runs> times (default 5), each time into a new CirMgr,
+// and reports the shortest wall-clock time of readCircuit() for it, then
+// the peak memory of the process. It only uses readCircuit(), so it
+// builds with the sources of the reader before the memory-mapped one as
+// well (see the Makefile).
+//
+
+static double
+wallTime()
+{
+   timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1e6;
+}
+
+int
+main(int argc, char** argv)
+{
+   int runs = 5, i = 1;
+   if(argc > 2 && string(argv[1]) == "-n") {
+      runs = atoi(argv[2]);
+      i = 3;
+   }
+   if(i >= argc || runs <= 0) {
+      cerr << "Usage: readBench [-n <runs>] <file>..." << endl;
+      return 1;
+   }
+   for(; i<argc; i++) {
+      double best = 0;
+      for(int r=0; r<runs; r++) {
+         cirMgr = new CirMgr;
+         double t = wallTime();
+         bool ok = cirMgr->readCircuit(argv[i]);
+         t = wallTime() - t;
+         delete cirMgr;   cirMgr = 0;
+         if(!ok) {
+            cerr << argv[i] << ": cannot be read!!" << endl;
+            return 1;
+         }
+         if(r == 0 || t < best)   best = t;
+      }
+      cout << setw(20) << left << argv[i] << " read " << fixed
+           << setprecision(3) << best << " s (best of " << runs << ")"
+           << endl;
+   }
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+   cout << "Peak memory: " << usage.ru_maxrss / 1024 << " MB" << endl;
+   return 0;
+}
@@ -0,0 +1,126 @@
+/****************************************************************************
+  FileName     [ simBench.cpp ]
+  PackageName  [ cir/bench ]
+  Synopsis     [ Time strash and simulation on large circuits ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <sys/time.h>
+#include "cirMgr.h"
+#include "rnGen.h"
+
+using namespace std;
+
+// IFSTREAM_SIM: fileSim() takes an ifstream, as it did before InFile
+#ifdef IFSTREAM_SIM
+typedef ifstream PatternFile;
+#else
+#include "myInFile.h"
+typedef InFile PatternFile;
+#endif
+
+// simBench [-n <runs>] [-p <patterns>] <file>...
+//
+// For each file, <runs> times (default 3): reads it into a new CirMgr,
+// then times strash() and fileSim() of <patterns> random input patterns
+// (default 1024, written to "<file>.pat" first), and reports the
+// shortest wall-clock time of each. The output of the commands is
+// dropped. It only uses what CirMgr had in the first commit, so it
+// builds with those sources as well (see the Makefile).
+//
+
+static double
+wallTime()
+{
+   timeval t;
+   gettimeofday(&t, 0);
+   return t.tv_sec + t.tv_usec / 1e6;
+}
+
+static bool
+openPatterns(PatternFile& f, const string& name)
+{
+#ifdef IFSTREAM_SIM
+   f.open(name.c_str());
+   return f.is_open();
+#else
+   return f.open(name);
+#endif
+}
+
+// the same patterns for the same circuit
+static bool
+writePatterns(const string& circuit, const string& name, unsigned n)
+{
+   ifstream f(circuit.c_str());
+   string tag;
+   unsigned M, I;
+   if(!(f >> tag >> M >> I))   return false;
+   ofstream o(name.c_str());
+   RandomNumGen rnGen(1);
+   string line(I, '0');
+   for(unsigned p=0; p<n; p++) {
+      for(unsigned i=0; i<I; i++)   line[i] = (rnGen(2) >= 1? '1': '0');
+      o << line << '\n';
+   }
+   return o.good();
+}
+
+int
+main(int argc, char** argv)
+{
+   int runs = 3, patterns = 1024, i = 1;
+   for(; i+1 < argc && argv[i][0] == '-'; i += 2) {
+      if(string(argv[i]) == "-n")   runs = atoi(argv[i+1]);
+      else if(string(argv[i]) == "-p")   patterns = atoi(argv[i+1]);
+      else   break;
+   }
+   if(i >= argc || runs <= 0 || patterns <= 0) {
+      cerr << "Usage: simBench [-n <runs>] [-p <patterns>] <file>..." << endl;
+      return 1;
+   }
+   streambuf* out = cout.rdbuf();
+   for(; i<argc; i++) {
+      string pat = string(argv[i]) + ".pat";
+      if(!writePatterns(argv[i], pat, patterns)) {
+         cerr << argv[i] << ": cannot write the patterns!!" << endl;
+         return 1;
+      }
+      double bestStrash = 0, bestSim = 0;
+      for(int r=0; r<runs; r++) {
+         cirMgr = new CirMgr;
+         cirMgr->setSimLog(0);   // not set by the first CirMgr()
+         if(!cirMgr->readCircuit(argv[i])) {
+            cerr << argv[i] << ": cannot be read!!" << endl;
+            return 1;
+         }
+         PatternFile f;
+         if(!openPatterns(f, pat)) {
+            cerr << pat << ": cannot be opened!!" << endl;
+            return 1;
+         }
+         cout.rdbuf(0);
+         double t = wallTime();
+         cirMgr->strash();
+         double strash = wallTime() - t;
+         t = wallTime();
+         cirMgr->fileSim(f);
+         double sim = wallTime() - t;
+         cout.rdbuf(out);
+         cout.clear();
+         delete cirMgr;   cirMgr = 0;
+         if(r == 0 || strash < bestStrash)   bestStrash = strash;
+         if(r == 0 || sim < bestSim)   bestSim = sim;
+      }
+      cout << setw(20) << left << argv[i] << fixed << setprecision(3)
+           << " strash " << bestStrash << " s, sim " << bestSim << " s ("
+           << patterns << " patterns, best of " << runs << ")" << endl;
+   }
+   return 0;
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+  FileName     [ cirAig.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the flat AIG view of the netlist ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_AIG_H
+#define CIR_AIG_H
+
+#include <vector>
+#include "cirDef.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------
+//   Define classes
+//------------------------------------------------------------------------
+// The Aig gates of the PO and next-state cones as plain arrays, without
+// gate objects. It is not the netlist itself: CirMgr::buildAig() makes
+// it from the gates for a command, and what the command changes is put
+// back on the gates. Node 0 is CONST, nodes 1.._I are the PIs, the next _L
+// nodes are the latches, then come the AND nodes in topological order,
+// and last _F nodes for the floating fanins, if they are asked to be
+// kept apart (see CirMgr::buildAig()).
+// A literal is node*2 + (inverted? 1: 0).
+//
+// Every AND node takes 8 bytes (its two fanin literals) plus the 4 bytes
+// of its gate ID. Per-node data, such as simulation values or the nodes
+// merged by strash, is kept by the user in arrays indexed by node,
+// parallel to these.
+//
+// Simulation and strash work on it; sweep needs no copy of the nodes,
+// and optimize and fraig work on the gates only.
+//
+class CirAig
+{
+   friend class CirMgr;
+
+public:
+   CirAig(): _I(0), _L(0), _F(0) {}
+   ~CirAig() {}
+
+   size_t size() const { return _gateID.size(); }
+   unsigned numPIs() const { return _I; }
+   unsigned numLatches() const { return _L; }
+   unsigned numFloating() const { return _F; }
+   unsigned firstAnd() const { return 1 + _I + _L; }
+   size_t numAnds() const { return _fanins.size()/2; }
+
+   unsigned fanin(size_t node, unsigned i) const {
+      return _fanins[(node - firstAnd())*2 + i]; }
+   unsigned next(unsigned latch) const { return _next[latch]; }
+   // of a floating node, the ID of the undefined gate
+   unsigned gateID(size_t node) const { return _gateID[node]; }
+
+   // value[] of every AND node from those of its fanins;
+   // value[0] has to be 0, and there must be no floating nodes (an
+   // inverted one would be 1, while a floating fanin is always 0)
+   template<class Word>
+   void simulate(Word* value) const {
+      const unsigned* f = _fanins.empty()? 0: &_fanins[0];
+      Word* v = value + firstAnd();
+      for(size_t i=0, n=numAnds(); i<n; i++, f+=2)
+         v[i] = (value[f[0]/2] ^ -(Word)(f[0]%2)) & (value[f[1]/2] ^ -(Word)(f[1]%2));
+   }
+   template<class Word>
+   Word literalValue(const Word* value, unsigned lit) const {
+      return value[lit/2] ^ -(Word)(lit%2); }
+
+private:
+   unsigned          _I, _L, _F;
+   IdList            _fanins;    // 2 literals per AND node
+   IdList            _next;      // next state literal per latch
+   IdList            _gateID;    // per node
+};
+
+#endif // CIR_AIG_H
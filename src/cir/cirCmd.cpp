@@ -13,6 +13,7 @@
 #include "cirGate.h"
 #include "cirCmd.h"
 #include "util.h"
+#include "myInFile.h"
 
 using namespace std;
 
@@ -23,6 +24,7 @@ bool
 initCirCmd()
 {
    if (!(cmdMgr->regCmd("CIRRead", 4, new CirReadCmd) &&
+         cmdMgr->regCmd("CIRMiter", 4, new CirMiterCmd) &&
          cmdMgr->regCmd("CIRPrint", 4, new CirPrintCmd) &&
          cmdMgr->regCmd("CIRGate", 4, new CirGateCmd) &&
          cmdMgr->regCmd("CIRSWeep", 5, new CirSweepCmd) &&
@@ -30,7 +32,9 @@ initCirCmd()
          cmdMgr->regCmd("CIRSTRash", 6, new CirStrashCmd) &&
          cmdMgr->regCmd("CIRSIMulate", 6, new CirSimCmd) &&
          cmdMgr->regCmd("CIRFraig", 4, new CirFraigCmd) &&
-         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd)
+         cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd) &&
+         cmdMgr->regCmd("CIRSAve", 5, new CirSaveCmd) &&
+         cmdMgr->regCmd("CIRLoad", 4, new CirLoadCmd)
       )) {
       cerr << "Registering \"cir\" commands fails... exiting" << endl;
       return false;
@@ -117,6 +121,73 @@ CirReadCmd::help() const
         << "read in a circuit and construct the netlist" << endl;
 }
 
+//----------------------------------------------------------------------
+//    CIRMiter <(string goldenFile)> <(string revisedFile)> [-Replace]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirMiterCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doReplace = false;
+   vector<string> fileNames;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Replace", options[i], 2) == 0) {
+         if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doReplace = true;
+      }
+      else {
+         if (fileNames.size() == 2)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         fileNames.push_back(options[i]);
+      }
+   }
+   if (fileNames.size() < 2)
+      return CmdExec::errorOption(CMD_OPT_MISSING, options.back());
+
+   if (cirMgr != 0) {
+      if (doReplace) {
+         cerr << "Note: original circuit is replaced..." << endl;
+         curCmd = CIRINIT;
+         delete cirMgr; cirMgr = 0;
+      }
+      else {
+         cerr << "Error: circuit already exists!!" << endl;
+         return CMD_EXEC_ERROR;
+      }
+   }
+   cirMgr = new CirMgr;
+
+   if (!cirMgr->readMiter(fileNames[0], fileNames[1])) {
+      curCmd = CIRINIT;
+      delete cirMgr; cirMgr = 0;
+      return CMD_EXEC_ERROR;
+   }
+
+   curCmd = CIRREAD;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirMiterCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRMiter <(string goldenFile)> <(string revisedFile)> [-Replace]"
+      << endl;
+}
+
+void
+CirMiterCmd::help() const
+{
+   cout << setw(15) << left << "CIRMiter: "
+        << "build the miter of two circuits for equivalence checking" << endl;
+}
+
 //----------------------------------------------------------------------
 //    CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating | -FECpairs]
 //----------------------------------------------------------------------
@@ -328,7 +399,7 @@ CirOptCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRSTRash
+//    CIRSTRash [-Stats]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirStrashCmd::exec(const string& option)
@@ -341,8 +412,14 @@ CirStrashCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (!options.empty())
-      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+   bool stats = false;
+   if (!options.empty()) {
+      if (myStrNCmp("-Stats", options[0], 2) != 0)
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[0]);
+      if (options.size() > 1)
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[1]);
+      stats = true;
+   }
 
    assert(curCmd != CIRINIT);
    if (curCmd == CIRSTRASH) {
@@ -354,7 +431,7 @@ CirStrashCmd::exec(const string& option)
            << endl;
       return CMD_EXEC_ERROR;
    }
-   cirMgr->strash();
+   cirMgr->strash(stats);
    curCmd = CIRSTRASH;
 
    return CMD_EXEC_DONE;
@@ -363,7 +440,7 @@ CirStrashCmd::exec(const string& option)
 void
 CirStrashCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRSTRash" << endl;
+   os << "Usage: CIRSTRash [-Stats]" << endl;
 }
 
 void
@@ -388,22 +465,31 @@ CirSimCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   ifstream patternFile;
+   InFile patternFile;
    ofstream logFile;
-   bool doRandom = false, doFile = false, doLog = false;
+   bool doRandom = false, doFile = false, doSeq = false, doLog = false;
+   int cycles = 0;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Random", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doSeq)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          doRandom = true;
       }
+      else if (myStrNCmp("-Sequential", options[i], 2) == 0) {
+         if (doRandom || doFile || doSeq)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], cycles) || cycles <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         doSeq = true;
+      }
       else if (myStrNCmp("-File", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doSeq)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
-         patternFile.open(options[i].c_str(), ios::in);
-         if (!patternFile)
+         if (!patternFile.open(options[i]))
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
          doFile = true;
       }
@@ -421,7 +507,7 @@ CirSimCmd::exec(const string& option)
          return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
 
-   if (!doRandom && !doFile)
+   if (!doRandom && !doFile && !doSeq)
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
    assert (curCmd != CIRINIT);
@@ -431,6 +517,8 @@ CirSimCmd::exec(const string& option)
 
    if (doRandom)
       cirMgr->randomSim();
+   else if (doSeq)
+      cirMgr->seqSim(cycles);
    else
       cirMgr->fileSim(patternFile);
    cirMgr->setSimLog(0);
@@ -442,7 +530,8 @@ CirSimCmd::exec(const string& option)
 void
 CirSimCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRSIMulate <-Random | -File <string patternFile>>\n"
+   os << "Usage: CIRSIMulate <-Random | -File <string patternFile> |\n"
+      << "                   -Sequential <int cycles>>\n"
       << "                   [-Output (string logFile)]" << endl;
 }
 
@@ -454,7 +543,7 @@ CirSimCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRFraig
+//    CIRFraig [-Stats]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirFraigCmd::exec(const string& option)
@@ -467,14 +556,20 @@ CirFraigCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (!options.empty())
-      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+   bool stats = false;
+   if (!options.empty()) {
+      if (myStrNCmp("-Stats", options[0], 2) != 0)
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[0]);
+      if (options.size() > 1)
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[1]);
+      stats = true;
+   }
 
    if (curCmd != CIRSIMULATE) {
       cerr << "Error: circuit is not yet simulated!!" << endl;
       return CMD_EXEC_ERROR;
    }
-   cirMgr->fraig();
+   cirMgr->fraig(stats);
    curCmd = CIRFRAIG;
 
    return CMD_EXEC_DONE;
@@ -483,7 +578,7 @@ CirFraigCmd::exec(const string& option)
 void
 CirFraigCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRFraig" << endl;
+   os << "Usage: CIRFraig [-Stats]" << endl;
 }
 
 void
@@ -494,7 +589,7 @@ CirFraigCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRWrite [(int gateId)][-Output (string aagFile)]
+//    CIRWrite [(int gateId)][-Output (string aagFile)][-Binary]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirWriteCmd::exec(const string& option)
@@ -511,7 +606,7 @@ CirWriteCmd::exec(const string& option)
       cirMgr->writeAag(cout);
       return CMD_EXEC_DONE;
    }
-   bool hasFile = false;
+   bool hasFile = false, doBinary = false;
    int gateId;
    CirGate *thisGate = NULL;
    ofstream outfile;
@@ -526,6 +621,11 @@ CirWriteCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[1]);
          hasFile = true;
       }
+      else if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (doBinary)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doBinary = true;
+      }
       else if (myStr2Int(options[i], gateId) && gateId >= 0) {
          if (thisGate != NULL)
             return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
@@ -542,7 +642,15 @@ CirWriteCmd::exec(const string& option)
       else return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
 
-   if (!thisGate) {
+   if (doBinary) {
+      if (thisGate) {
+         cerr << "Error: a single gate cannot be written in binary!!" << endl;
+         return CMD_EXEC_ERROR;
+      }
+      if (hasFile) cirMgr->writeAig(outfile);
+      else cirMgr->writeAig(cout);
+   }
+   else if (!thisGate) {
       assert (hasFile);
       cirMgr->writeAag(outfile);
    }
@@ -555,13 +663,113 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)]"
+      << "[-Binary]" << endl;
 }
 
 void
 CirWriteCmd::help() const
 {
    cout << setw(15) << left << "CIRWrite: "
-        << "write the netlist to an ASCII AIG file (.aag)\n";
+        << "write the netlist to an AIG file (.aag or .aig)\n";
 }
 
+//----------------------------------------------------------------------
+//    CIRSAve <(string snapshotFile)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSaveCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token, false))
+      return CMD_EXEC_ERROR;
+
+   if (!cirMgr->saveSnapshot(token, curCmd))
+      return CMD_EXEC_ERROR;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSaveCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSAve <(string snapshotFile)>" << endl;
+}
+
+void
+CirSaveCmd::help() const
+{
+   cout << setw(15) << left << "CIRSAve: "
+        << "save the netlist to a binary snapshot\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRLoad <(string snapshotFile)> [-Replace]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirLoadCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doReplace = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Replace", options[i], 2) == 0) {
+         if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doReplace = true;
+      }
+      else {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         fileName = options[i];
+      }
+   }
+
+   if (cirMgr != 0) {
+      if (doReplace) {
+         cerr << "Note: original circuit is replaced..." << endl;
+         curCmd = CIRINIT;
+         delete cirMgr; cirMgr = 0;
+      }
+      else {
+         cerr << "Error: circuit already exists!!" << endl;
+         return CMD_EXEC_ERROR;
+      }
+   }
+   cirMgr = new CirMgr;
+
+   unsigned state = CIRINIT;
+   if (!cirMgr->loadSnapshot(fileName, state) || state >= CIRCMDTOT) {
+      curCmd = CIRINIT;
+      delete cirMgr; cirMgr = 0;
+      return CMD_EXEC_ERROR;
+   }
+
+   // resume where the snapshot was taken
+   curCmd = (state == CIRINIT)? CIRREAD: CirCmdState(state);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirLoadCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRLoad <(string snapshotFile)> [-Replace]" << endl;
+}
+
+void
+CirLoadCmd::help() const
+{
+   cout << setw(15) << left << "CIRLoad: "
+        << "load a netlist from a binary snapshot\n";
+}
@@ -12,6 +12,7 @@
 #include "cmdParser.h"
 
 CmdClass(CirReadCmd);
+CmdClass(CirMiterCmd);
 CmdClass(CirPrintCmd);
 CmdClass(CirGateCmd);
 CmdClass(CirSweepCmd);
@@ -20,5 +21,7 @@ CmdClass(CirStrashCmd);
 CmdClass(CirSimCmd);
 CmdClass(CirFraigCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirSaveCmd);
+CmdClass(CirLoadCmd);
 
 #endif // CIR_CMD_H
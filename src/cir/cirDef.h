@@ -30,6 +30,11 @@ enum opt
 	X_1, X_0, X_X, X_nX, X_Y
 };
 
+enum GateType
+{
+	PI_GATE, PO_GATE, AIG_GATE, CONST_GATE, LATCH_GATE
+};
+
 class ID
 {
 public:
@@ -42,4 +47,37 @@ private:
 	unsigned _id;
 };
 
+// the two gates of a SAT proof, each by the literals of its fanins,
+// smaller first (see proofLits() in cirFraig.cpp); the gate pairs of
+// equal keys have the same functions, and so the same verdict
+class ProofKey
+{
+public:
+	ProofKey() { _lits[0] = _lits[1] = _lits[2] = _lits[3] = 0; }
+	ProofKey(unsigned a0, unsigned a1, unsigned b0, unsigned b1) {
+		bool swap = (a0 > b0 || (a0 == b0 && a1 > b1));
+		_lits[0] = (swap? b0: a0);	_lits[1] = (swap? b1: a1);
+		_lits[2] = (swap? a0: b0);	_lits[3] = (swap? a1: b1);
+	}
+
+	// the first gate times a large odd number, the second added in, and
+	// then the 64-bit finalizer of MurmurHash3
+	size_t operator() () const {
+		unsigned long long h = ((unsigned long long)_lits[0] << 32) | _lits[1];
+		h *= 0x9e3779b97f4a7c15ULL;
+		h ^= ((unsigned long long)_lits[2] << 32) | _lits[3];
+		h ^= h >> 33;  h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return (size_t)h;
+	}
+	bool operator== (const ProofKey& k) const {
+		return (_lits[0] == k._lits[0] && _lits[1] == k._lits[1] &&
+		        _lits[2] == k._lits[2] && _lits[3] == k._lits[3]);
+	}
+
+private:
+	unsigned _lits[4];
+};
+
 #endif // CIR_DEF_H
@@ -7,8 +7,11 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <iomanip>
+#include <algorithm>
 #include "cirMgr.h"
 #include "cirGate.h"
+#include "cirAig.h"
 #include "sat.h"
 #include "myHashMap.h"
 #include "util.h"
@@ -25,77 +28,237 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// entries of CirMgr::_proofCache
+static const size_t proofCacheSize = 1 << 14;
+
+// an AIG by its fanin literals, smaller first; any other gate by its own
+// literal twice, as the AND of itself and itself
+static void
+proofLits(const CirGate* g, unsigned& a, unsigned& b)
+{
+   if(g->isAig()) {
+      a = g->faninLiteral(0);   b = g->faninLiteral(1);
+      if(a > b)   { unsigned t = a;   a = b;   b = t; }
+   }
+   else  a = b = g->getGateID()*2;
+}
+
+// The AND nodes of a CirAig by their strash keys, in linear probing,
+// each as its node index: 4 bytes a slot, with at most 3/4 of them in
+// use. The key of a node is not kept but taken again from its fanins,
+// through repr[], the literal each node has been merged into (or its
+// own); as the nodes come in topological order, the fanins of a node
+// have their final repr[] by the time it is looked up.
+class StrashTable
+{
+public:
+   StrashTable(const CirAig& aig, const IdList& repr): _aig(aig), _repr(repr) {
+      size_t c = 8;
+      while(c * 3 < aig.numAnds() * 4)   c *= 2;
+      _slots.assign(c, 0);
+      _size = 0;
+   }
+   ~StrashTable() {}
+
+   StrashKey key(unsigned node) const {
+      unsigned a = _aig.fanin(node, 0), b = _aig.fanin(node, 1);
+      return StrashKey(_repr[a/2] ^ (a%2), _repr[b/2] ^ (b%2));
+   }
+   // the node already in with the key of "node", or "node", which is
+   // put in (node 0, CONST, is never an AND and marks an empty slot)
+   unsigned insert(unsigned node) {
+      StrashKey k = key(node);
+      size_t mask = _slots.size() - 1, i = k() & mask;
+      for(; _slots[i]; i = (i + 1) & mask)
+         if(key(_slots[i]) == k)   return _slots[i];
+      _slots[i] = node;
+      _size++;
+      return node;
+   }
+   void printStats() const;
+
+private:
+   const CirAig&     _aig;
+   const IdList&     _repr;
+   IdList            _slots;
+   size_t            _size;
+};
+
+// how far the keys are from their home slots, and how many of them
+// share a whole 64-bit hash with another key
+void
+StrashTable::printStats() const
+{
+   ios::fmtflags flags = cout.flags();
+   streamsize prec = cout.precision();
+   size_t n = _size, cap = _slots.size(), mask = cap - 1;
+   cout << "Strash hash: " << n << " keys in " << cap << " slots (load "
+        << fixed << setprecision(2) << (double)n / cap << ")" << endl;
+   vector<size_t> probes, hashes;
+   hashes.reserve(n);
+   for(size_t i=0; i<cap; i++) {
+      if(!_slots[i])   continue;
+      size_t h = key(_slots[i])(), d = (i - h) & mask;
+      if(d >= probes.size())   probes.resize(d + 1, 0);
+      probes[d]++;
+      hashes.push_back(h);
+   }
+   size_t total = 0;
+   cout << "  probes        keys" << endl;
+   for(size_t d=0; d<probes.size(); d++) {
+      if(!probes[d])   continue;
+      cout << setw(8) << right << d+1 << setw(12) << probes[d] << endl;
+      total += (d+1) * probes[d];
+   }
+   if(n)   cout << "Average probes: " << (double)total / n << endl;
+   sort(hashes.begin(), hashes.end());
+   size_t shared = 0;
+   for(size_t i=0; i<hashes.size(); i++)
+      if((i > 0 && hashes[i] == hashes[i-1]) ||
+         (i+1 < hashes.size() && hashes[i] == hashes[i+1]))   shared++;
+   cout << "Keys sharing a 64-bit hash: " << shared << endl;
+   cout.flags(flags);
+   cout.precision(prec);
+}
 
 /*******************************************/
 /*   Public member functions about fraig   */
 /*******************************************/
 // _floatList may be changed.
 // _unusedList and _undefList won't be changed
+// _dfsList only loses the merged gates
+// "stats": report how the keys spread over the hash
+//
+// The AIGs of _dfsList are hashed as the AND nodes of a CirAig, with a
+// floating fanin as a node of its own, so that only the same fanins
+// give the same key; a node merged into an earlier one is seen as that
+// one by the nodes after it. The merges are then made on the gates.
 void
-CirMgr::strash()
+CirMgr::strash(bool stats)
 {
-   HashMap<StrashKey, CirGate_p>  strashMap(getHashSize(_A));
-   StrashKey key;
-   CirGate_p temp, host;
-   for(size_t i=0, n = _dfsList.size(); i<n; i++) {
-      temp = getGate(_dfsList[i]);
-      if(!temp->isAig())   continue;
-      key = temp->getStrashKey();
-      if(strashMap.query(key, host)) {
-         cout << "Strashing: ";
-         mergeGate(temp, host);
+   CirAig aig;
+   buildAig(aig, _dfsList, true);
+   IdList repr(aig.size()), merged;
+   for(size_t n=0; n<repr.size(); n++)   repr[n] = n*2;
+   {
+      StrashTable table(aig, repr);
+      for(size_t n=aig.firstAnd(), end=n+aig.numAnds(); n<end; n++) {
+         unsigned host = table.insert(n);
+         if(host == n)   continue;
+         repr[n] = host*2;
+         merged.push_back(n);
+         cout << "Strashing: " << aig.gateID(host) << " merging "
+              << aig.gateID(n) << " ..." << endl;
+      }
+      if(stats)   table.printStats();
+   }
+   // the fanouts of a merged gate come after it in _dfsList, so none of
+   // them has been freed yet. A few merges are made on the fanout sets
+   // of the gates they touch, and the CSR is copied once with them; many
+   // are left to buildFanouts(), which makes the CSR anew from the fanins
+   bool few = (merged.size() * 64 < aig.numAnds());
+   vector<CirGate::CirGateSP> fanouts;
+   for(size_t i=0; i<merged.size(); i++) {
+      CirGate* from = getGate(aig.gateID(merged[i]));
+      CirGate* to = getGate(aig.gateID(repr[merged[i]]/2));
+      if(few)
+         for(size_t k=0; k<from->_fanin.size(); k++)
+            if(!from->_fanin[k].isFlt())
+               from->_fanin[k].gate()->delFanout(CirGate::CirGateSP(from, from->_fanin[k].isInv()));
+      from->getFanouts(fanouts);
+      for(size_t j=0; j<fanouts.size(); j++) {
+         CirGate* temp = fanouts[j].gate();
+         CirGate::CirGateSP in(from, fanouts[j].isInv());
+         for(size_t k=0; k<temp->_fanin.size(); k++)
+            if(temp->_fanin[k] == in)
+               temp->_fanin[k] = CirGate::CirGateSP(to, fanouts[j].isInv());
+         if(few)   to->addFanout(fanouts[j]);
       }
-      else  strashMap.insert(key, temp);
+      freeGate(aig.gateID(merged[i]), from);
    }
-   _floatingList.clear();
-   setFloatingList();
+   compactAigList();
+   compactDFSList();
+   if(few)   rebuildFanouts();
+   else  buildFanouts();
+   updateLists(false);
 }
 
+// "stats": report the hits of the SAT verdicts kept from before
+// "cache": false to prove every pair again (and drop what was kept)
 void
-CirMgr::fraig()
+CirMgr::fraig(bool stats, bool cache)
 {
+   if(!cache)   _proofCache.reset();
+   else if(_proofCache.size() == 0)   _proofCache.init(proofCacheSize);
    SatSolver sat;
    sat.initialize();
    
    genProofModel(sat);
 
+   // the levels of the Aig gates out of the DFS list as well, for the
+   // merges below
+   MarkSet visited(_gateList.size());
+   IdList order, levels;
+   for(size_t i=0; i<_AigList.size(); i++)
+      if(getGate(_AigList[i]))
+         dfsPostOrder(getGate(_AigList[i]), visited, order, levels);
+
    unsigned newInput = 0;
    FECGrp_p group;
-   unsigned* sampleInputs = new unsigned[_I];
-   for(size_t i=0; i<_I; i++) sampleInputs[i] = 0;
+   unsigned* sampleInputs = new unsigned[_I+_L];
+   for(size_t i=0; i<_I+_L; i++) sampleInputs[i] = 0;
    while(!_FECList->empty()) {
       group = _FECList->back();
-      for(size_t j = 0, m = group->size(); j<m-1; j++)
-         for(size_t k = j+1; k<m; k++) {
+      for(size_t j = 0; j+1 < group->size(); j++)
+         for(size_t k = j+1; k < group->size(); ) {
             if(!proveSat(sat, (*group)[j], (*group)[k], sampleInputs)) {
-               mergeGate((*group)[j], (*group)[k]);   break;
+               // the one of the higher level goes, so that no gate takes
+               // over a fanout in its own fanin cone
+               if((*group)[k]->getLevel() < (*group)[j]->getLevel())
+                  swap((*group)[j], (*group)[k]);
+               mergeGate((*group)[k], (*group)[j]);
+               group->erase(group->begin() + k);
             }
-            else newInput++;
+            else { newInput++;   k++; }
          }
       delete group;
       _FECList->pop_back();
-      if(newInput > 20) {
+      // (simulate() would start the groups over once they are all done)
+      if(newInput > 20 && !_FECList->empty()) {
          simulate(sampleInputs);
          cout << newInput << " patterns simulated." << endl;
-         for(size_t i=0; i<_I; i++) sampleInputs[i] = 0;
+         for(size_t i=0; i<_I+_L; i++) sampleInputs[i] = 0;
          newInput = 0;
       }
    }
+   delete [] sampleInputs;
    delete _FECList;
    _FECList = new vector<FECGrp*>;
+   // the merges may put a host after the fanouts it takes over
+   updateLists(true);
    strash();
+   if(stats) {
+      size_t hits = _proofCache.hits(), n = hits + _proofCache.misses();
+      cout << "Proof cache: " << hits << " hits, " << _proofCache.misses()
+           << " misses, " << _proofCache.evictions() << " evictions";
+      if(n)   cout << " (" << hits * 100 / n << "% hit)";
+      cout << endl;
+   }
 }
 
 /********************************************/
 /*   Private member functions about fraig   */
 /********************************************/
 
+// "from" is "to" inverted if their values are
 bool
 CirMgr::mergeGate(CirGate* from, CirGate* to)
 {
    if(from == to) return false;
-	from->mergeInto(to);
-   cout << to->getGateID() << " merging " << from->getGateID() << " ..." << endl;
+   bool inv = (from->getSimValue(_simFed) != to->getSimValue(_simFed));
+	from->mergeInto(to, inv);
+   cout << to->getGateID() << " merging " << (inv? "!": "")
+        << from->getGateID() << " ..." << endl;
    freeGate(from->getGateID(), from);
 	return true;
 }
@@ -111,6 +274,11 @@ CirMgr::genProofModel(SatSolver& sat)
       temp = getGate(_PIList[i]);
       temp->setVar(sat.newVar());
    }
+   // latches are free variables, like PIs
+   for(size_t i=0; i<_L; i++) {
+      temp = getGate(_LatchList[i]);
+      temp->setVar(sat.newVar());
+   }
    for(size_t i=0; i<_A; i++) {
       temp = getGate(_AigList[i]);
       temp->setVar(sat.newVar());
@@ -150,24 +318,34 @@ bool
 CirMgr::proveSat(SatSolver& sat, CirGate* gateA, CirGate* gateB, unsigned* sample)
 {
    bool result;
+   unsigned a0, a1, b0, b1;
+   proofLits(gateA, a0, a1);
+   proofLits(gateB, b0, b1);
+   ProofKey key(a0, a1, b0, b1);
+   if(_proofCache.read(key, result)) {
+      // no pattern is added for a SAT verdict from the cache
+      cout << "Updating by "<< (result? "SAT": "UNSAT")
+           << "  Total FEC group = " << _FECList->size() << endl;
+      return result;
+   }
    Var topVar = sat.newVar();
    Var c0 = getGate(0)->getVar();
-   if(gateA->getSimValue() == gateB->getSimValue())
-      sat.addXorCNF(topVar, gateA->getVar(), true, gateB->getVar(), false);
-   else 
-      sat.addXorCNF(topVar, gateA->getVar(), true, gateB->getVar(), false);
+   // topVar is 1 where the two differ, in the phase of their FEC group
+   bool inv = (gateA->getSimValue(_simFed) != gateB->getSimValue(_simFed));
+   sat.addXorCNF(topVar, gateA->getVar(), inv, gateB->getVar(), false);
    
    sat.assumeRelease();
    sat.assumeProperty(c0, false);
    sat.assumeProperty(topVar, true);
    result = sat.assumpSolve();
+   _proofCache.write(key, result);
 
    cout << "Updating by "<< (result? "SAT": "UNSAT")
         << "  Total FEC group = " << _FECList->size() << endl;
    if(result) {
       CirGate* temp;
-      for(size_t i=0; i<_I; i++) {
-         temp = getGate(_PIList[i]);
+      for(size_t i=0; i<_I+_L; i++) {
+         temp = getGate(i<_I? _PIList[i]: _LatchList[i-_I]);
          sample[i] = sample[i] << 1;
          sample[i] += (unsigned)sat.getValue(temp->getVar());
       }
@@ -23,7 +23,6 @@ using namespace std;
 //       your own variables and functions.
 
 extern CirMgr *cirMgr;
-size_t CirGate::_markFlagRef = 0;
 
 /**************************************/
 /*   class CirGate member functions   */
@@ -33,7 +32,8 @@ CirGate::reportGate() const
 {
 	cout << "==================================================" << endl;
 	cout << "= " << getTypeStr() << "(" << getGateID() << ")";
-	if(!cirMgr->getSymb(_gateID).empty())	cout << "\"" << cirMgr->getSymb(_gateID) << "\"";
+	StrRef symbol = cirMgr->getSymb(_gateID);
+	if(!symbol.empty())	cout << "\"" << symbol << "\"";
 	cout << ", line " << getLineNo() << endl;
 	cout << "==================================================" << endl;
 }
@@ -42,24 +42,23 @@ void
 CirGate::reportFanin(int& level) const
 {
    assert (level >= 0);
-	_markFlagRef++;
-	reportFaninRC(level, 1);
+	MarkSet seen;
+	reportFaninRC(level, 1, seen);
 }
 
 void
-CirGate::reportFaninRC(int level, int tab) const
+CirGate::reportFaninRC(int level, int tab, MarkSet& seen) const
 {
 	cout << getTypeStr() << " " << _gateID;
-	if(_markFlag == _markFlagRef)	{ cout << " (*)" << endl;	return; }
+	if(!seen.markNew(_gateID))	{ cout << " (*)" << endl;	return; }
 	cout << endl;
-	_markFlag = _markFlagRef;	
 	if(level != 0){
 		for(size_t i=0; i<_fanin.size(); i++){
 			for(int j=0; j<tab; j++)	cout << "  ";		// tab for the following one
 			if(_fanin[i].isFlt())	cout << "UNDEF " << _fanin[i].literal()/2;
 			else {
 				if(_fanin[i].isInv())	cout << "!";
-				_fanin[i].gate()->reportFaninRC(level-1, tab+1);
+				_fanin[i].gate()->reportFaninRC(level-1, tab+1, seen);
 			}
 		}
 	}
@@ -69,61 +68,65 @@ void
 CirGate::reportFanout(int& level) const
 {
    assert (level >= 0);
-	_markFlagRef++;
-	reportFanoutRC(level, 1);
+	MarkSet seen;
+	reportFanoutRC(level, 1, seen);
 }
 
 void
-CirGate::reportFanoutRC(int level, int tab) const
+CirGate::reportFanoutRC(int level, int tab, MarkSet& seen) const
 {
 	cout << getTypeStr() << " " << _gateID;
-	if(_markFlag == _markFlagRef)	{ cout << " (*)" << endl;	return; }
+	if(!seen.markNew(_gateID))	{ cout << " (*)" << endl;	return; }
 	cout << endl;
-	_markFlag = _markFlagRef;	
 	if(level != 0){
-		for(size_t i=0; i<_fanout.size(); i++){
+		for(size_t i=0; i<_foNum; i++){
 			for(int j=0; j<tab; j++)	cout << "  ";		// tab for the following one
-			if(_fanout[i].isInv())	cout << "!";
-			_fanout[i].gate()->reportFanoutRC(level-1, tab+1);
+			if(_foList[i].isInv())	cout << "!";
+			_foList[i].gate()->reportFanoutRC(level-1, tab+1, seen);
 		}
 	}
 }
 
-void
-CirGate::setDFSList_RC(IdList& _dfsList) const
-{
-	for(size_t i=0; i<_fanin.size(); i++){
-		if(!_fanin[i].isFlt()) _fanin[i].gate()->setDFSList_RC(_dfsList);
-	}
-	if(_markFlag != _markFlagRef){
-      _dfsList.push_back(_gateID);
-		_markFlag = _markFlagRef;
-	}
-}
-
 
 bool
 CirGate::addFanout(CirGateSP p)
 {
-	for(vector<CirGateSP>::iterator it = _fanout.begin(); it!=_fanout.end(); it++)		
-		if(*it == p)	return false;
-	_fanout.push_back(p);
-   ::sort(_fanout.begin(), _fanout.end());
-	return true;
+	ownFanouts();
+	return _foSet->insert(p._gateSP);
 }
 
 
 void
 CirGate::delFanout(CirGateSP p){
-	for(vector<CirGateSP>::iterator it = _fanout.begin(); it!=_fanout.end(); it++)
-		if(*it == p)	{ _fanout.erase(it); break; }
+	ownFanouts();
+	_foSet->remove(p._gateSP);
+}
+
+// sorted only if they are not changed in this command
+void
+CirGate::getFanouts(vector<CirGateSP>& list) const
+{
+	if(!_foSet)	{ list.assign(_foList, _foList + _foNum);	return; }
+	list.clear();
+	list.reserve(_foSet->size());
+	for(HashSet<FanoutKey>::iterator it = _foSet->begin(); it!=_foSet->end(); it++)
+		list.push_back(CirGateSP((CirGate*)((*it)() & ~(size_t)NEG), (*it)() & NEG));
+}
+
+// move the fanouts out of the CSR before they are changed
+void
+CirGate::ownFanouts()
+{
+	if(_foSet)	return;
+	_foSet = new HashSet<FanoutKey>(_foNum);
+	for(size_t i=0; i<_foNum; i++)	_foSet->insert(_foList[i]._gateSP);
 }
 
 // doesn't change the _fanin list itself
 void
 CirGate::clearFanin() {
 	unsigned sign;
-	for(vector<CirGateSP>::iterator it = _fanin.begin(); it!=_fanin.end(); it++) {
+	for(CirFanins::iterator it = _fanin.begin(); it!=_fanin.end(); it++) {
       if(it->isFlt())   continue;
 		sign = (it->isInv()? 1: 0);
 		it->gate()->delFanout(CirGateSP(this, sign));
@@ -134,11 +137,10 @@ CirGate::clearFanin() {
 // if from == to, simply remove the item
 void
 CirGate::changeFanin(CirGateSP from, CirGateSP to){
-	for(vector<CirGateSP>::iterator it = _fanin.begin(); it!=_fanin.end(); it++)
+	for(CirFanins::iterator it = _fanin.begin(); it!=_fanin.end(); it++)
 		if(*it == from) {
-			if(from == to) _fanin.erase(it);
-			else *it = to;
-			break;
+			if(from == to) { _fanin.erase(it);	break; }
+			*it = to;	// both fanins may be "from"
 		}
 }
 
@@ -12,9 +12,12 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <cassert>
 #include "cirDef.h"
 #include "cirMgr.h"
 #include "sat.h"
+#include "myMarkSet.h"
+#include "myHashSet.h"
 
 using namespace std;
 
@@ -25,49 +28,77 @@ extern CirMgr *cirMgr;
 //------------------------------------------------------------------------
 //   Define classes
 //------------------------------------------------------------------------
+// the two fanin literals of an AIG, smaller first, so equal keys are
+// the same AND whatever the order of the fanins or the gate addresses
 class StrashKey
 {
 public:
-   StrashKey(): _key(0) {}
-   StrashKey(const size_t a, const size_t b) { _key = (a << 20) + b; }
-
-   size_t operator() () const { return _key; }
-   bool operator== (const StrashKey& k) const { return (k._key == _key); }
+   StrashKey(): _a(0), _b(0) {}
+   StrashKey(unsigned a, unsigned b) {
+      if(a > b) { unsigned t = a; a = b; b = t; }
+      _a = a; _b = b;
+   }
+
+   // the 64-bit finalizer of MurmurHash3, so both literals reach every bit
+   size_t operator() () const {
+      unsigned long long h = ((unsigned long long)_a << 32) | _b;
+      h ^= h >> 33;  h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return (size_t)h;
+   }
+   bool operator== (const StrashKey& k) const { return (k._a == _a && k._b == _b); }
 
 private:
-   size_t   _key;
+   unsigned _a, _b;
 };
  
+// the value of a CirGateSP, as kept in the fanout sets
+class FanoutKey
+{
+public:
+   FanoutKey(size_t sp = 0): _sp(sp) {}
+
+   size_t operator() () const { return _sp; }
+   bool operator== (const FanoutKey& k) const { return (k._sp == _sp); }
+
+private:
+   size_t   _sp;
+};
+
 class CirGateSP;
 class CirGate
 {
 public:
 
 	friend class CirMgr;
+	friend class CirFanouts;
 
-   CirGate(unsigned id, unsigned line): _gateID(id), _lineNo(line) {}
-   virtual ~CirGate() {}
+   CirGate(GateType type, unsigned id, unsigned line)
+      : _gateID(id), _lineNo(line), _level(0), _type(type), _foList(0), _foNum(0), _foSet(0) {}
+   virtual ~CirGate() { delete _foSet; }
 
    // Basic access methods
    void setVar(const Var& v) { _var = v; }
    virtual string getTypeStr() const = 0;
-	virtual bool isAig() const = 0;
+	GateType getType() const { return _type; }
+	bool isAig() const { return (_type == AIG_GATE); }
+	bool isLatch() const { return (_type == LATCH_GATE); }
    unsigned getLineNo() const { return _lineNo; }
 	unsigned getGateID() const { return _gateID; }
+	unsigned getLevel() const { return _level; }
    Var getVar() const { return _var; }
    opt checkOpt() const;
-   // bool isMarked() const { return (_markFlag == _markFlagRef); }
 	bool floating() const;
-	bool unUsed() const { return _fanout.empty(); }
+	bool unUsed() const { return (_foSet? _foSet->empty(): _foNum == 0); }
+	unsigned getFaninNum() const { return _fanin.size(); }
 	unsigned faninLiteral(size_t i) const { return _fanin[i].literal(); }
-   virtual StrashKey getStrashKey() const = 0;
 	
    // Printing functions
    virtual void printGate() const = 0;		// called by print netlist
    void reportGate() const;
    void reportFanin(int& level) const;
    void reportFanout(int& level) const;
-	void setDFSList_RC(IdList& _dfsList) const;
 
 protected:
 	// "signed pointer"
@@ -75,16 +106,21 @@ protected:
 	// if constructed as a pointer, it's a pointer and the last bit is used to show negation
 	// if constructed as a size_t, it's the literal ID and marked at the last second bit
 	// so that we know it's a floating input
+	class CirFanins;
 	class CirGateSP
 	{
+		friend class CirMgr;
+		friend class CirFanins;
 		friend class CirGate;
 		friend class AigGate;
 		friend class POGate;
+		friend class LatchGate;
 		
 		#define NEG 0x1
 		#define FLT 0x2
 		CirGateSP(CirGate* p, size_t sign): _gateSP((size_t)p + sign) {}
 		CirGateSP(size_t literal): _gateSP(literal*8 + FLT) {}
+		CirGateSP(): _gateSP(0) {}
 
    public:
 		bool operator == (const CirGateSP& comp) const { return (_gateSP == comp._gateSP); }
@@ -102,38 +138,73 @@ protected:
 		size_t	_gateSP;
 	};
 
+	// a gate has at most two fanins; they are kept in the gate itself,
+	// with the part of the interface of vector<CirGateSP> that is used
+	class CirFanins
+	{
+	public:
+		typedef CirGateSP* iterator;
+
+		CirFanins(): _num(0) {}
+
+		size_t size() const { return _num; }
+		CirGateSP& operator [] (size_t i) { return _list[i]; }
+		const CirGateSP& operator [] (size_t i) const { return _list[i]; }
+		iterator begin() { return _list; }
+		iterator end() { return _list + _num; }
+		void push_back(const CirGateSP& p) { assert(_num < 2);	_list[_num++] = p; }
+		void erase(iterator it) {
+			for(; it+1 != end(); it++)	*it = *(it+1);
+			_num--;
+		}
+
+	private:
+		CirGateSP	_list[2];
+		unsigned		_num;
+	};
+
 public:
    // basic helping functions
 	virtual void connectLinks() = 0;
 	bool addFanout(CirGateSP p);
 	void delFanout(CirGateSP p);
+	void getFanouts(vector<CirGateSP>& list) const;
 	void clearFanin();
 	void changeFanin(CirGateSP from, CirGateSP to);
 
 	// optimizing and fraig functions
-	void mergeInto(CirGate* host);
+	void mergeInto(CirGate* host, bool inv = false);
    void addClause(SatSolver& sat, Var& c0);
    void replaceByConst(CirGate* gate, unsigned sign);
    void replaceByFanin(unsigned number);
 
    // simulating functions
-   void feedInput(unsigned input) { _value = input;   _markFlag = _markFlagRef; }
-   unsigned getSimValue();
+   // "fed" has the gates whose values are of the current patterns
+   void feedInput(unsigned input, MarkSet& fed) { _value = input;   fed.mark(_gateID); }
+   unsigned getSimValue(MarkSet& fed) {
+      return (fed.isMarked(_gateID)? _value: evalSimValue(fed)); }
 
-	static size_t		_markFlagRef;
 private:
 	// for recursive use
-	void reportFaninRC(int level, int tab) const;
-	void reportFanoutRC(int level, int tab) const;
+	void reportFaninRC(int level, int tab, MarkSet& seen) const;
+	void reportFanoutRC(int level, int tab, MarkSet& seen) const;
+	unsigned evalSimValue(MarkSet& fed);
+	void ownFanouts();
 
 protected:
 	unsigned				_gateID;
 	unsigned				_lineNo;
+	unsigned				_level;		// 0 for PI, CONST and latch
    unsigned          _value;
    Var               _var;
-	mutable size_t		_markFlag;
-	vector<CirGateSP>	_fanin;
-	vector<CirGateSP>	_fanout;
+	GateType				_type;
+	CirFanins			_fanin;
+	// the fanouts, sorted, are a slice of the CSR of CirMgr until they
+	// are changed; then they are moved to _foSet, which is folded back
+	// into the CSR at the end of the command (CirMgr::rebuildFanouts())
+	const CirGateSP*	_foList;
+	unsigned				_foNum;
+	HashSet<FanoutKey>*	_foSet;
 };
 
 
@@ -145,7 +216,7 @@ public:
 	// when first constructed, inputs are all stored as literal IDs
 	// member function connectLink() has to be called afterward to link them as pointers
 	AigGate(unsigned id, unsigned line, size_t input1, size_t input2)
-		: CirGate(id, line) {
+		: CirGate(AIG_GATE, id, line) {
       if(input1 < input2){
          _fanin.push_back(CirGateSP(input1));
          _fanin.push_back(CirGateSP(input2));
@@ -158,23 +229,16 @@ public:
 	~AigGate() {}
 
    string getTypeStr() const { return "AIG"; }
-	bool isAig() const { return true; }
-   StrashKey getStrashKey() const { return StrashKey(_fanin[0]._gateSP, _fanin[1]._gateSP); } 
 	// link input nodes with signed pointer
 	// if node not found, leave it as literal ID
+	// the fanouts are built by CirMgr afterwards
 	void connectLinks(){
 		size_t liID = _fanin[0].literal();
 		CirGate* temp = cirMgr->getGate(liID/2);
-		if(temp){
-			_fanin[0] = CirGateSP(temp, liID%2);
-			temp->addFanout(CirGateSP(this, liID%2));
-		}
+		if(temp)	_fanin[0] = CirGateSP(temp, liID%2);
 		liID = _fanin[1].literal();
 		temp = cirMgr->getGate(liID/2);
-		if(temp){
-			_fanin[1] = CirGateSP(temp, liID%2);
-			temp->addFanout(CirGateSP(this, liID%2));
-		}
+		if(temp)	_fanin[1] = CirGateSP(temp, liID%2);
 	}
    void printGate() const {
 		cout << getTypeStr() << " " << _gateID << " ";
@@ -200,15 +264,14 @@ class PIGate :public CirGate
    friend class CirMgr;
 
 public:
-	PIGate(unsigned id, unsigned line): CirGate(id, line) {}
+	PIGate(unsigned id, unsigned line): CirGate(PI_GATE, id, line) {}
 	~PIGate() {}
 
    string getTypeStr() const { return "PI"; }
-   StrashKey getStrashKey() const { return StrashKey(); } 
-	bool isAig() const { return false; }
    void printGate() const {
 		cout << getTypeStr() << "  " << _gateID;
-		if(!cirMgr->getSymb(_gateID).empty())	cout << " (" << cirMgr->getSymb(_gateID) << ")";
+		StrRef symbol = cirMgr->getSymb(_gateID);
+		if(!symbol.empty())	cout << " (" << symbol << ")";
 		cout << endl;
 	}
 	void connectLinks() {};
@@ -217,6 +280,43 @@ private:
 };
 
 
+// a latch is a source, like a PI, in DFS and simulation;
+// its only fanin is the next state
+class LatchGate :public CirGate
+{
+   friend class CirMgr;
+
+public:
+	// when first constructed, the next state is stored as literal ID
+	// member function connectLink() has to be called afterward to link it as pointer
+	LatchGate(unsigned id, unsigned line, size_t next)
+		: CirGate(LATCH_GATE, id, line) {
+		_fanin.push_back(CirGateSP(next));
+		_value = 0;
+	}
+	~LatchGate() {}
+
+   string getTypeStr() const { return "LATCH"; }
+	void connectLinks(){
+		size_t liID = _fanin[0].literal();
+		CirGate* temp = cirMgr->getGate(liID/2);
+		if(temp)	_fanin[0] = CirGateSP(temp, liID%2);
+	}
+   void printGate() const {
+		cout << getTypeStr() << " " << _gateID << " ";
+		if(_fanin[0].isFlt()) cout << "*" << (_fanin[0].literal()%2? "!": "") << _fanin[0].literal()/2;
+		else{
+			if(_fanin[0].isInv())	cout<<"!";
+			cout << _fanin[0].gate()->getGateID();
+		}
+		StrRef symbol = cirMgr->getSymb(_gateID);
+		if(!symbol.empty())	cout << " (" << symbol << ")";
+		cout << endl;
+	}
+private:
+};
+
+
 class POGate :public CirGate
 {
    friend class CirMgr;
@@ -225,23 +325,19 @@ public:
 	// when first constructed, inputs are all stored as literal IDs
 	// member function connectLink() has to be called afterward to link them as pointers
 	POGate(unsigned id, unsigned line, size_t input)
-		: CirGate(id, line) {
+		: CirGate(PO_GATE, id, line) {
 		_fanin.push_back(CirGateSP(input));
 	}
 	~POGate() {}
 
    string getTypeStr() const { return "PO"; }
-	bool isAig() const { return false; }
-   StrashKey getStrashKey() const { return StrashKey(); } 
 	// link input nodes with signed pointer
 	// if node not found, leave it as literal ID
+	// the fanouts are built by CirMgr afterwards
 	void connectLinks(){
 		size_t liID = _fanin[0].literal();
 		CirGate* temp = cirMgr->getGate(liID/2);
-		if(temp){
-			_fanin[0] = CirGateSP(temp, liID%2);
-			temp->addFanout(CirGateSP(this, liID%2));
-		}
+		if(temp)	_fanin[0] = CirGateSP(temp, liID%2);
 	}
    void printGate() const {
 		cout << getTypeStr() << "  " << _gateID << " ";
@@ -250,7 +346,8 @@ public:
 			if(_fanin[0].isInv())	cout<<"!";
 			cout << _fanin[0].gate()->getGateID();
 		}
-		if(!cirMgr->getSymb(_gateID).empty())	cout << " (" << cirMgr->getSymb(_gateID) << ")";
+		StrRef symbol = cirMgr->getSymb(_gateID);
+		if(!symbol.empty())	cout << " (" << symbol << ")";
 		cout << endl;
 	}
 private:
@@ -263,15 +360,23 @@ class ConstGate :public CirGate
    friend class CirMgr;
 
 public:
-	ConstGate(): CirGate(0, 0) { _value = 0; }
+	ConstGate(): CirGate(CONST_GATE, 0, 0) { _value = 0; }
 	~ConstGate() {}
 
    string getTypeStr() const { return "CONST"; }
-	bool isAig() const { return false; }
-   StrashKey getStrashKey() const { return StrashKey(); } 
 	void connectLinks(){}
 	void printGate() const { cout << "CONST0" << endl; }
 private:
 };
 
+// the fanouts of all the gates in one array (CSR), in the order of
+// gate IDs; each gate points to its own slice
+class CirFanouts
+{
+   friend class CirMgr;
+
+private:
+	vector<CirGate::CirGateSP>	_list;
+};
+
 #endif // CIR_GATE_H
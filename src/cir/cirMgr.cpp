@@ -7,6 +7,7 @@
 ****************************************************************************/
 
 #include <iostream>
+#include <new>
 #include <fstream>
 #include <iomanip>
 #include <cstdio>
@@ -17,8 +18,13 @@
 #include <algorithm>
 #include "cirMgr.h"
 #include "cirGate.h"
+#include "cirAig.h"
 #include "cirDef.h"
 #include "util.h"
+#include "myInFile.h"
+#include "myOutBuf.h"
+#include "myThread.h"
+#include "myMemPool.h"
 
 using namespace std;
 
@@ -57,11 +63,216 @@ enum CirParseError {
 /**************************************/
 static unsigned lineNo = 0;  // in printint, lineNo needs to ++
 static unsigned colNo  = 0;  // in printing, colNo needs to ++
-static char buf[1024];
 static string errMsg;
 static int errInt;
 static CirGate *errGate;
 
+// in CirMgr::buildAig(), a floating fanin before it is numbered
+static const unsigned FLOAT_LIT = 1u << 31;
+static const char* lineBegin = 0;  // where line lineNo starts
+
+// scanners for the memory-mapped file
+// they never go beyond "end" and never allocate; on error, p is left
+// at the offending character and the error is returned (DUMMY_END if
+// everything is fine), so that they can also run on worker threads
+
+// same as isspace() in the "C" locale, without a table lookup
+static inline bool
+isWSpace(char c)
+{
+	return (c == ' ' || (unsigned)(c - '\t') <= '\r' - '\t');
+}
+
+// a number that starts right at p and ends at a white space or the end
+static inline CirParseError
+scanNum(const char*& p, const char* end, unsigned& n)
+{
+	if(p == end || *p == '\n')	return MISSING_NUM;
+	if(*p == ' ')	return EXTRA_SPACE;
+	if(isWSpace(*p))	return ILLEGAL_WSPACE;
+	const char* q = p;
+	for(n = 0; q < end && (unsigned)(*q - '0') <= 9; q++)	n = n*10 + (*q - '0');
+	if(q == p || (q < end && !isWSpace(*q)))	return ILLEGAL_NUM;
+	p = q;
+	return DUMMY_END;
+}
+
+// the single space between two numbers (a missing one is reported as
+// MISSING_NUM of the next number), or the end of the line;
+// the last line of a file may go without its '\n'
+static inline CirParseError
+scanSep(const char*& p, const char* end, bool last)
+{
+	if(last){
+		if(p < end && *p != '\n')	return MISSING_NEWLINE;
+	}
+	else if(p == end || *p == '\n')	return MISSING_NUM;
+	else if(*p != ' ')	return ILLEGAL_WSPACE;
+	if(p < end)	p++;
+	return DUMMY_END;
+}
+
+// a literal that defines a PI or an AIG
+static inline CirParseError
+checkDefLit(unsigned lit, unsigned M)
+{
+	if(lit/2 == 0)	return REDEF_CONST;
+	if(lit/2 > M)	return MAX_LIT_ID;
+	if(lit%2)	return CANNOT_INVERTED;
+	return DUMMY_END;
+}
+
+// "lhs rhs0 rhs1\n"; on error, field is the literal it belongs to
+// redefinitions are not checked here
+static CirParseError
+scanAigLine(const char*& p, const char* end, unsigned M, unsigned* lit,
+            unsigned& field)
+{
+	for(field=0; field<3; field++){
+		const char* tok = p;
+		CirParseError err = scanNum(p, end, lit[field]);
+		if(err == DUMMY_END){
+			if(field == 0)	err = checkDefLit(lit[0], M);
+			else if(lit[field]/2 > M)	err = MAX_LIT_ID;
+			if(err != DUMMY_END)	p = tok;
+		}
+		if(err == DUMMY_END){
+			err = scanSep(p, end, field == 2);
+			if(err == MISSING_NUM)	field++;
+		}
+		if(err != DUMMY_END)	return err;
+	}
+	return DUMMY_END;
+}
+
+static inline const char*
+aigLitName(unsigned field)
+{
+	return (field? "AIG input literal ID": "AIG gate literal ID");
+}
+
+// binary AIGER number: 7 bits per byte, LSB first,
+// MSB set means more bytes follow
+// return false if the number is cut off by "end"
+static inline bool
+decodeUInt(const char*& p, const char* end, unsigned& n)
+{
+	unsigned char ch;
+	unsigned shift = 0;
+	n = 0;
+	do {
+		if(p == end)	return false;
+		ch = *p++;
+		n |= (unsigned)(ch & 0x7f) << shift;
+		shift += 7;
+	} while(ch & 0x80);
+	return true;
+}
+
+// parallel reading of the ASCII AIG section
+// the section is cut into chunks at line boundaries; each chunk first
+// counts its lines, so that it knows the index of its first AIG line,
+// and then parses its own lines into a preallocated literal array
+static const unsigned AIGS_PER_TASK = 1 << 15;
+static const unsigned MAX_TASKS = 16;
+
+// the first error of a chunk; _line is _A if there is none
+struct AigLineError
+{
+	unsigned						_line;
+	CirParseError				_err;
+	unsigned						_field;
+	const char*					_begin;	// of the line
+	const char*					_pos;
+};
+
+struct AigChunks
+{
+	unsigned						_M, _A;
+	vector<const char*>		_begin;	// chunk k is [_begin[k], _begin[k+1])
+	vector<unsigned>			_first;	// index of the first line of chunk k
+	vector<unsigned>			_lits;	// lhs, rhs0, rhs1 of each AIG line
+	const char*					_after;	// just after the last AIG line
+	vector<AigLineError>		_errs;	// one per chunk
+};
+
+static unsigned
+parseTasks(unsigned nAigs)
+{
+	unsigned n = nAigs / AIGS_PER_TASK;
+	if(n > numCores())	n = numCores();
+	if(n > MAX_TASKS)	n = MAX_TASKS;
+	return (n? n: 1);
+}
+
+static void
+countLines(void* arg, unsigned k, unsigned)
+{
+	AigChunks* c = (AigChunks*)arg;
+	const char* end = c->_begin[k+1];
+	unsigned n = 0;
+	for(const char* q = c->_begin[k];
+	    (q = (const char*)memchr(q, '\n', end - q)) != 0; q++)	n++;
+	c->_first[k+1] = n;
+}
+
+static void
+parseAigLines(void* arg, unsigned k, unsigned)
+{
+	AigChunks* c = (AigChunks*)arg;
+	AigLineError& e = c->_errs[k];
+	const char* p = c->_begin[k];
+	const char* end = c->_begin[k+1];
+	unsigned i = c->_first[k];
+	e._line = c->_A;
+	for(; i < c->_A && p < end; i++){
+		const char* begin = p;
+		e._err = scanAigLine(p, end, c->_M, &c->_lits[3*(size_t)i], e._field);
+		if(e._err != DUMMY_END){
+			e._line = i;	e._begin = begin;	e._pos = p;
+			return;
+		}
+		if(i+1 == c->_A)	c->_after = p;
+	}
+	// only the last chunk can run out of lines
+	if(i < c->_A && k+1 == c->_begin.size()-1){
+		e._line = i;	e._err = MISSING_DEF;	e._field = 0;
+		e._begin = e._pos = p;
+	}
+}
+
+// parallel linking; the phases run one after another over all tasks
+enum LinkPhase
+{
+	LINK_FANIN,		// over sinks: fanin literals to pointers, count fanouts
+	LINK_FILL,		// over sinks: fill the fanout CSR
+	LINK_SORT		// over IDs: sort and unique as addFanout() does
+};
+
+// a gate on the stack of dfsPostOrder(); _num fanins to visit, and the
+// highest level of the ones visited
+struct DFSFrame
+{
+	DFSFrame(CirGate* g): _gate(g), _next(0), _num(g->isLatch()? 0: g->getFaninNum()),
+		_level(0), _aig(g->isAig()) {}
+
+	CirGate*						_gate;
+	unsigned						_next;
+	unsigned						_num;
+	unsigned						_level;
+	bool							_aig;
+};
+
+struct AigLinks
+{
+	LinkPhase					_phase;
+	const vector<CirGate*>*	_gates;	// _gateList
+	vector<CirGate*>			_sinks;	// AIGs, POs, then latches
+	vector<unsigned>			_count;	// by ID; #fanouts, then fill cursor
+	vector<unsigned>			_first;	// by ID; slice in _list
+	CirFanouts*					_fanouts;	// the CSR to fill
+};
+
 static bool
 parseError(CirParseError err)
 {
@@ -149,96 +360,366 @@ parseError(CirParseError err)
    return false;
 }
 
+// report err at p of line lineNo; "what" names the number there
+static bool
+parseErrorAt(CirParseError err, const char* p, const char* end,
+             const char* what, unsigned n = 0)
+{
+	colNo = p - lineBegin;
+	errMsg = what;
+	errInt = n;
+	switch(err){
+	case ILLEGAL_WSPACE:
+	case ILLEGAL_SYMBOL_NAME:
+		errInt = (unsigned char)*p;	break;
+	case ILLEGAL_NUM: {
+		const char* q = p;
+		while(q < end && !isWSpace(*q))	q++;
+		errMsg = errMsg + "(" + string(p, q) + ")";
+		break;
+	}
+	case CANNOT_INVERTED:	// e.g. "PI literal ID" -> "PI"
+		errMsg = errMsg.substr(0, errMsg.find(" literal"));	break;
+	default: break;
+	}
+	return parseError(err);
+}
+
 /**************************************************************/
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
 bool
 CirMgr::readCircuit(const string& fileName)
 {
-	// open the file
-	ifstream input(fileName.c_str());
-	if(!input){
+	// map the whole file; every number is scanned in place
+	// a compressed file is scanned in a window that is refilled
+	// before each line
+	// the file is validated while the netlist is built; the first
+	// error is reported by parseError() and false is returned
+	InFile input;
+	if(!input.open(fileName)){
 		cerr << "Failed to open file " << fileName <<endl;	return false;
 	}
+	const char* p = input.begin();
+	const char* end = input.end();
+	CirParseError err;
+	unsigned field;
 	// header
-	string str;
-	getline(input,str);
-	stringstream ss(str);
-	ss.ignore(4);
-	ss >> _M;	ss.ignore();
-	ss >> _I;	ss.ignore();
-	ss >> _L;	ss.ignore();
-	ss >> _O;	ss.ignore();
-	ss >> _A;
-	// all the gate are store in map _gateList
+	// "aag" is the ASCII format and "aig" the binary one;
+	// they differ only in the PI and AIG sections
+	input.refill(p, end);
+	lineNo = 0;	lineBegin = p;
+	const char* tok = p;
+	while(p < end && !isWSpace(*p))	p++;
+	if(p == tok){
+		if(p < end && *p == ' ')	return parseErrorAt(EXTRA_SPACE, p, end, "");
+		if(p < end && *p != '\n')	return parseErrorAt(ILLEGAL_WSPACE, p, end, "");
+		errMsg = "aag";	return parseError(MISSING_IDENTIFIER);
+	}
+	bool binary = (p - tok == 3 && strncmp(tok, "aig", 3) == 0);
+	if(!binary && (p - tok != 3 || strncmp(tok, "aag", 3) != 0)){
+		errMsg = string(tok, p);	return parseError(ILLEGAL_IDENTIFIER);
+	}
+	static const char* headerName[] = { "number of variables",
+		"number of PIs", "number of latches", "number of POs", "number of AIGs" };
+	unsigned* header[] = { &_M, &_I, &_L, &_O, &_A };
+	for(field=0; field<5; field++){
+		err = scanSep(p, end, false);
+		if(err == DUMMY_END)	err = scanNum(p, end, *header[field]);
+		if(err != DUMMY_END)	return parseErrorAt(err, p, end, headerName[field]);
+	}
+	if((err = scanSep(p, end, true)) != DUMMY_END)
+		return parseErrorAt(err, p, end, "");
+	if(_M < _I + _L + _A){
+		errMsg = "Number of variables";	errInt = _M;
+		return parseError(NUM_TOO_SMALL);
+	}
+	// all the gate are store in _gateList, indexed by gate ID
 	// every type of gate has its own IDList
-   _gateList.init(getHashSize(_M));
+	// a gate is redefined if its slot is taken
+   _gateList.assign(_M+_O+1, 0);
    _FECList = new vector<FECGrp*>;
    _FECReady = false;
+	_PIList.reserve(_I);	_POList.reserve(_O);	_AigList.reserve(_A);
+	_LatchList.reserve(_L);
 	// Const 0
-	CirGate* c0 = new ConstGate;
-	_gateList.insert(0, c0);
+	_gateList[0] = new(allocGate()) ConstGate;
 	// PIs
-	unsigned line = 1;
-	int content;
+	unsigned content = 0;
 	for(unsigned i=0; i<_I; i++){
-		getline(input,str);	line++;
-		ss.str("");	ss.clear();	// I found that this step is neccessary to reset a stringstream
-		ss << str;					// only ss.str(str) would not work
-		ss >> content;
-		CirGate* pi = new PIGate(content/2, line);
-		_gateList.insert(content/2, pi);
+		lineNo++;
+		// binary PIs are implicit: literal 2, 4, ..., 2*I
+		if(binary)	content = 2*(i+1);
+		else {
+			input.refill(p, end);
+			lineBegin = tok = p;
+			if(p == end){	errMsg = "PI";	return parseError(MISSING_DEF); }
+			err = scanNum(p, end, content);
+			if(err == DUMMY_END && (err = checkDefLit(content, _M)) != DUMMY_END)	p = tok;
+			if(err == DUMMY_END && _gateList[content/2]){
+				errInt = content;	errGate = _gateList[content/2];
+				return parseError(REDEF_GATE);
+			}
+			if(err == DUMMY_END)	err = scanSep(p, end, true);
+			if(err != DUMMY_END)	return parseErrorAt(err, p, end, "PI literal ID", content);
+		}
+		CirGate* pi = new(allocGate()) PIGate(content/2, lineNo+1);
+		_gateList[content/2] = pi;
 		_PIList.push_back(content/2);
 	}
+	// latches: "lhs next"
+	// binary latches are "next" only (lhs = 2*(I+i+1))
+	for(unsigned i=0; i<_L; i++){
+		unsigned next = 0;
+		lineNo++;
+		input.refill(p, end);
+		lineBegin = tok = p;
+		if(p == end){	errMsg = "latch";	return parseError(MISSING_DEF); }
+		err = DUMMY_END;
+		field = 0;
+		if(binary)	content = 2*(_I+i+1);
+		else {
+			err = scanNum(p, end, content);
+			if(err == DUMMY_END && (err = checkDefLit(content, _M)) != DUMMY_END)	p = tok;
+			if(err == DUMMY_END && _gateList[content/2]){
+				errInt = content;	errGate = _gateList[content/2];
+				return parseError(REDEF_GATE);
+			}
+			if(err == DUMMY_END && (err = scanSep(p, end, false)) == MISSING_NUM)	field = 1;
+		}
+		if(err == DUMMY_END){
+			field = 1;	tok = p;
+			err = scanNum(p, end, next);
+			if(err == DUMMY_END && next/2 > _M){	err = MAX_LIT_ID;	p = tok; }
+			if(err == DUMMY_END)	err = scanSep(p, end, true);
+		}
+		if(err != DUMMY_END)
+			return parseErrorAt(err, p, end, (field? "latch next state literal ID": "latch literal ID"),
+			                    (field? next: content));
+		CirGate* latch = new(allocGate()) LatchGate(content/2, lineNo+1, next);
+		_gateList[content/2] = latch;
+		_LatchList.push_back(content/2);
+	}
 	// POs
 	for(unsigned i=1; i<=_O; i++){
-		getline(input,str);	line++;
-		ss.str("");	ss.clear();
-		ss << str;
-		ss >> content;
-		CirGate* po = new POGate(_M+i, line, content);
-		_gateList.insert(_M+i, po);
+		lineNo++;
+		input.refill(p, end);
+		lineBegin = tok = p;
+		if(p == end){	errMsg = "PO";	return parseError(MISSING_DEF); }
+		err = scanNum(p, end, content);
+		if(err == DUMMY_END && content/2 > _M){	err = MAX_LIT_ID;	p = tok; }
+		if(err == DUMMY_END)	err = scanSep(p, end, true);
+		if(err != DUMMY_END)	return parseErrorAt(err, p, end, "PO literal ID", content);
+		CirGate* po = new(allocGate()) POGate(_M+i, lineNo+1, content);
+		_gateList[_M+i] = po;
 		_POList.push_back(_M+i);
 	}
 	// AIGs
-	size_t input1, input2;
-	for(unsigned i=0; i<_A; i++){
-		getline(input,str);	line++;
-		ss.str("");	ss.clear();
-		ss << str;
-		ss >> content;	ss.ignore();
-		ss >> input1;	ss.ignore();
-		ss >> input2;
-		CirGate* aig = new AigGate(content/2, line, input1, input2);
-		_gateList.insert(content/2, aig);
-		_AigList.push_back(content/2);
+	// binary AIGs are implicit (lhs = 2*(I+L+i+1)), followed by
+	// two deltas: lhs - rhs0 and rhs0 - rhs1
+	// line numbers are counted as if the file were in ASCII
+	// huge ASCII sections are parsed by several threads
+	unsigned nTasks = (binary || input.isStream()? 1: parseTasks(_A));
+	if(nTasks > 1){
+		if(!readAigsParallel(p, end, nTasks))	return false;
+	}
+	else for(unsigned i=0; i<_A; i++){
+		unsigned lit[3] = { 0, 0, 0 };
+		lineNo++;
+		if(binary){
+			unsigned delta0 = 0, delta1 = 0;
+			lit[0] = 2*(_I+_L+i+1);
+			input.refill(p, end, 10);	// two 5-byte numbers at most
+			if(!decodeUInt(p, end, delta0) || !decodeUInt(p, end, delta1)){
+				errMsg = "AIG";	return parseError(MISSING_DEF);
+			}
+			if(delta0 == 0 || delta0 > lit[0] || delta1 > lit[0] - delta0){
+				errMsg = "AIG input delta";	return parseError(ILLEGAL_NUM);
+			}
+			lit[1] = lit[0] - delta0;
+			lit[2] = lit[1] - delta1;
+		}
+		else{
+			input.refill(p, end);
+			lineBegin = p;
+			if(p == end){	errMsg = "AIG";	return parseError(MISSING_DEF); }
+			err = scanAigLine(p, end, _M, lit, field);
+			if((err == DUMMY_END || field > 0) && _gateList[lit[0]/2]){
+				errInt = lit[0];	errGate = _gateList[lit[0]/2];
+				return parseError(REDEF_GATE);
+			}
+			if(err != DUMMY_END)
+				return parseErrorAt(err, p, end, aigLitName(field), lit[field]);
+		}
+		CirGate* aig = new(allocGate()) AigGate(lit[0]/2, lineNo+1, lit[1], lit[2]);
+		_gateList[lit[0]/2] = aig;
+		_AigList.push_back(lit[0]/2);
 	}
 	// when gates are constructed, inputs are stored as literal ID
 	// now link them with pointers
-	for(unsigned i=0; i<_A; i++) {   getGate(_AigList[i])->connectLinks(); }
-	for(unsigned i=1; i<=_O; i++) {	getGate(_M+i)->connectLinks();	}
+	if(nTasks > 1)	connectLinksParallel(nTasks);
+	else {
+		for(unsigned i=0; i<_A; i++) {   getGate(_AigList[i])->connectLinks(); }
+		for(unsigned i=1; i<=_O; i++) {	getGate(_M+i)->connectLinks();	}
+		for(unsigned i=0; i<_L; i++) {	getGate(_LatchList[i])->connectLinks();	}
+		buildFanouts();
+	}
+	// symbols
+	// stored in _symbolList
+	// the name is the rest of the line; a 'c' line starts the comments
+	while(input.refill(p, end), p < end){
+		lineNo++;
+		lineBegin = p;
+		char head = *p;
+		if(head == 'c'){
+			if(++p < end && *p != '\n')	return parseErrorAt(MISSING_NEWLINE, p, end, "");
+			break;
+		}
+		if(head == ' ')	return parseErrorAt(EXTRA_SPACE, p, end, "");
+		if(isWSpace(head))	return parseErrorAt(ILLEGAL_WSPACE, p, end, "");
+		if(head != 'i' && head != 'o' && head != 'l'){
+			return parseErrorAt(ILLEGAL_SYMBOL_TYPE, p, end, string(1, head).c_str());
+		}
+		p++;
+		if((err = scanNum(p, end, content)) != DUMMY_END)
+			return parseErrorAt(err, p, end, "symbol index");
+		const IdList& list = (head == 'i'? _PIList: head == 'o'? _POList: _LatchList);
+		if(content >= list.size()){
+			errMsg = (head == 'i'? "PI index": head == 'o'? "PO index": "latch index");
+			errInt = content;
+			return parseError(NUM_TOO_BIG);
+		}
+		if(p < end && *p != ' ' && *p != '\n')	return parseErrorAt(ILLEGAL_WSPACE, p, end, "");
+		if(p < end && *p == ' ')	p++;
+		const char* name = p;
+		for(; p < end && *p != '\n'; p++)
+			if(!isprint(*p))	return parseErrorAt(ILLEGAL_SYMBOL_NAME, p, end, "");
+		if(p == name){	errMsg = "symbolic name";	return parseError(MISSING_IDENTIFIER); }
+		if(!_symbolList.insert(list[content], StrRef(name, p - name))){
+			errMsg = string(1, head);	errInt = content;
+			return parseError(REDEF_SYMBOLIC_NAME);
+		}
+		if(p < end)	p++;
+	}
 	// set _floatingList, _unUsedList,  _dfsList, and _FECList
 	setFloatingList();
 	setUnUsedList();
    setDFSList();
-	// symbols
-	// stored in map _symbolList
-	char head;
-	string name;
-	while(getline(input, str)){
-		ss.str("");	ss.clear();
-		ss << str;
-		ss >> head >> content;	ss.ignore();
-		ss >> name;
-		switch(head){
-		case 'i':
-			_symbolList[_PIList[content]] = name;	break;
-		case 'o':
-			_symbolList[_POList[content]] = name;	break;
+   return true;
+}
+
+// same gates, in the same order and with the same line numbers,
+// as the serial loop in readCircuit(); the lines are validated by
+// the workers except for redefinitions, which are found here in order
+bool
+CirMgr::readAigsParallel(const char*& p, const char* end, unsigned nTasks)
+{
+	AigChunks c;
+	c._M = _M;
+	c._A = _A;
+	c._after = end;
+	c._begin.resize(nTasks+1);
+	c._first.assign(nTasks+1, 0);
+	c._lits.assign(3*(size_t)_A, 0);
+	c._errs.resize(nTasks);
+	c._begin[0] = p;
+	c._begin[nTasks] = end;
+	for(unsigned k=1; k<nTasks; k++){
+		const char* q = p + taskBegin(end - p, k, nTasks);
+		if(q < c._begin[k-1])	q = c._begin[k-1];
+		q = (const char*)memchr(q, '\n', end - q);
+		c._begin[k] = (q? q+1: end);
+	}
+	runTasks(countLines, &c, nTasks);
+	for(unsigned k=1; k<=nTasks; k++)	c._first[k] += c._first[k-1];
+	runTasks(parseAigLines, &c, nTasks);
+
+	const AigLineError* e = 0;
+	for(unsigned k=0; k<nTasks && !e; k++)
+		if(c._errs[k]._line < _A)	e = &c._errs[k];
+	unsigned base = lineNo;
+	for(unsigned i=0; i<_A; i++){
+		const unsigned* lit = &c._lits[3*(size_t)i];
+		bool bad = (e && e->_line == i);
+		lineNo = base+i+1;
+		if((!bad || e->_field > 0) && _gateList[lit[0]/2]){
+			errInt = lit[0];	errGate = _gateList[lit[0]/2];
+			return parseError(REDEF_GATE);
+		}
+		if(bad){
+			lineBegin = e->_begin;
+			if(e->_err == MISSING_DEF){	errMsg = "AIG";	return parseError(MISSING_DEF); }
+			return parseErrorAt(e->_err, e->_pos, end, aigLitName(e->_field), lit[e->_field]);
+		}
+		CirGate* aig = new(allocGate()) AigGate(lit[0]/2, lineNo+1, lit[1], lit[2]);
+		_gateList[lit[0]/2] = aig;
+		_AigList.push_back(lit[0]/2);
+	}
+	p = c._after;
+	return true;
+}
+
+// the same links as connectLinks() on every AIG, PO and latch, and
+// the same fanouts as buildFanouts()
+void
+CirMgr::connectLinksParallel(unsigned nTasks)
+{
+	AigLinks l;
+	l._gates = &_gateList;
+	l._sinks.reserve(_A + _O + _L);
+	for(unsigned i=0; i<_AigList.size(); i++)	l._sinks.push_back(getGate(_AigList[i]));
+	for(unsigned i=1; i<=_O; i++)	l._sinks.push_back(getGate(_M+i));
+	for(unsigned i=0; i<_LatchList.size(); i++)	l._sinks.push_back(getGate(_LatchList[i]));
+	size_t n = _gateList.size();
+	l._count.assign(n, 0);
+	l._phase = LINK_FANIN;	runTasks(linkTask, &l, nTasks);
+	l._first.assign(n+1, 0);
+	for(size_t i=0; i<n; i++)	l._first[i+1] = l._first[i] + l._count[i];
+	l._count.assign(l._first.begin(), l._first.end()-1);
+	if(!_fanouts)	_fanouts = new CirFanouts;
+	_fanouts->_list.assign(l._first[n], CirGate::CirGateSP((size_t)0));
+	l._fanouts = _fanouts;
+	l._phase = LINK_FILL;	runTasks(linkTask, &l, nTasks);
+	l._phase = LINK_SORT;	runTasks(linkTask, &l, nTasks);
+}
+
+void
+CirMgr::linkTask(void* arg, unsigned k, unsigned nTasks)
+{
+	AigLinks* l = (AigLinks*)arg;
+	const vector<CirGate*>& gates = *l->_gates;
+	vector<CirGate::CirGateSP>& list = l->_fanouts->_list;
+	bool bySink = (l->_phase == LINK_FANIN || l->_phase == LINK_FILL);
+	size_t size = (bySink? l->_sinks.size(): gates.size());
+	size_t first = taskBegin(size, k, nTasks), last = taskBegin(size, k+1, nTasks);
+	for(size_t i=first; i<last; i++){
+		if(bySink){
+			CirGate* sink = l->_sinks[i];
+			for(size_t j=0; j<sink->_fanin.size(); j++){
+				CirGate::CirGateSP& in = sink->_fanin[j];
+				if(l->_phase == LINK_FANIN){
+					unsigned lit = in.literal();
+					if(lit/2 >= gates.size() || !gates[lit/2])	continue;
+					in = CirGate::CirGateSP(gates[lit/2], lit%2);
+					__sync_fetch_and_add(&l->_count[lit/2], 1);
+				}
+				else if(!in.isFlt()){
+					CirGate* fanin = in.gate();
+					unsigned slot = __sync_fetch_and_add(&l->_count[fanin->_gateID], 1);
+					list[slot] = CirGate::CirGateSP(sink, in.isInv());
+				}
+			}
+		}
+		else if(gates[i]){
+			vector<CirGate::CirGateSP>::iterator out = list.begin() + l->_first[i];
+			vector<CirGate::CirGateSP>::iterator end = list.begin() + l->_count[i];
+			::sort(out, end);
+			gates[i]->_foNum = ::unique(out, end) - out;
+			gates[i]->_foList = (list.empty()? 0: &list[0] + l->_first[i]);
+			delete gates[i]->_foSet;
+			gates[i]->_foSet = 0;
 		}
 	}
-	input.close();
-   return true;
 }
 
 /**********************************************************/
@@ -261,9 +742,10 @@ CirMgr::printSummary() const
 	cout << "==================" << endl;
 	cout << "  PI  " << setw(10) << right << _I << endl;
 	cout << "  PO  " << setw(10) << right << _O << endl;
+	if(_L)	cout << "  LATCH" << setw(9) << right << _L << endl;
 	cout << "  AIG " << setw(10) << right << _A << endl;
 	cout << "------------------" << endl;
-	cout << "  Total" << setw(9) << right << _I+_O+_A << endl;
+	cout << "  Total" << setw(9) << right << _I+_O+_L+_A << endl;
 }
 
 void
@@ -319,32 +801,176 @@ CirMgr::writeAag(ostream& outfile) const
 	IdList DFSAigList;
 	for(size_t i=0; i<_AigList.size(); i++)
 		if(!getGate(_AigList[i])->unUsed())	DFSAigList.push_back(_AigList[i]);
+	// everything goes through one buffer; nothing is flushed per line
+	OutBuf out(outfile);
 	// header
-	outfile << "aag " << _M << " " << _I << " " << _L << " " << _O 
-			  <<	" " << DFSAigList.size() << endl;
-	// PIs POs
-	for(size_t i=0; i<_PIList.size(); i++)	outfile << _PIList[i]*2 << endl;
-	for(size_t i=0; i<_POList.size(); i++) outfile << getGate(_POList[i])->faninLiteral(0) << endl;
+	out.put("aag ").putUInt(_M).put(' ').putUInt(_I).put(' ').putUInt(_L)
+	   .put(' ').putUInt(_O).put(' ').putUInt(DFSAigList.size()).put('\n');
+	// PIs latches POs
+	for(size_t i=0; i<_PIList.size(); i++)	out.putUInt(_PIList[i]*2).put('\n');
+	for(size_t i=0; i<_LatchList.size(); i++)
+		out.putUInt(_LatchList[i]*2).put(' ').putUInt(getGate(_LatchList[i])->faninLiteral(0)).put('\n');
+	for(size_t i=0; i<_POList.size(); i++) out.putUInt(getGate(_POList[i])->faninLiteral(0)).put('\n');
 	// Aigs
 	CirGate* temp;
 	for(size_t i=0; i<DFSAigList.size(); i++){
 		temp = getGate(DFSAigList[i]);
-		outfile << temp->getGateID()*2;		outfile << " ";
-		outfile << temp->faninLiteral(0);	outfile << " ";
-		outfile << temp->faninLiteral(1);	outfile << endl;
+		out.putUInt(temp->getGateID()*2).put(' ');
+		out.putUInt(temp->faninLiteral(0)).put(' ');
+		out.putUInt(temp->faninLiteral(1)).put('\n');
 	}
 	// symbols
-	string symbol;
+	writeSymbols(out);
+	out.put("c\nAAG output by Yun (Teresa) Chou\n");
+}
+
+// binary AIGER requires PIs to be numbered 1..I, latches I+1..I+L and
+// every AIG to be numbered after its fanins, so the AIGs in the PO and
+// next-state cones are renumbered in DFS post order.
+// Floating fanins become CONST0 (as in simulation).
+void
+CirMgr::writeAig(ostream& outfile) const
+{
+	// new variable of each gate ID; 0 for CONST and floating gates
+	vector<unsigned> var(_M+_O+1, 0);
+	for(size_t i=0; i<_PIList.size(); i++)	var[_PIList[i]] = i+1;
+	for(size_t i=0; i<_LatchList.size(); i++)	var[_LatchList[i]] = _I+i+1;
+	IdList order;
+	aigPostOrder(order);
+	for(size_t i=0; i<order.size(); i++)	var[order[i]] = _I+_L+i+1;
+
+	OutBuf out(outfile);
+	out.put("aig ").putUInt(_I + _L + order.size()).put(' ').putUInt(_I).put(' ')
+	   .putUInt(_L).put(' ').putUInt(_O).put(' ').putUInt(order.size()).put('\n');
+	// latches (next state only) and POs
+	for(size_t i=0; i<_LatchList.size(); i++){
+		unsigned lit = getGate(_LatchList[i])->faninLiteral(0);
+		out.putUInt(var[lit/2]*2 + lit%2).put('\n');
+	}
+	for(size_t i=0; i<_POList.size(); i++){
+		unsigned lit = getGate(_POList[i])->faninLiteral(0);
+		out.putUInt(var[lit/2]*2 + lit%2).put('\n');
+	}
+	// Aigs: two deltas, lhs - rhs0 and rhs0 - rhs1 with rhs0 >= rhs1
+	for(size_t i=0; i<order.size(); i++){
+		CirGate* temp = getGate(order[i]);
+		unsigned lhs = var[order[i]]*2;
+		unsigned rhs0 = var[temp->faninLiteral(0)/2]*2 + temp->faninLiteral(0)%2;
+		unsigned rhs1 = var[temp->faninLiteral(1)/2]*2 + temp->faninLiteral(1)%2;
+		if(rhs0 < rhs1)	{ unsigned t = rhs0;	rhs0 = rhs1;	rhs1 = t; }
+		out.putVarUInt(lhs - rhs0).putVarUInt(rhs0 - rhs1);
+	}
+	// symbols
+	writeSymbols(out);
+	out.put("c\nAIG output by Yun (Teresa) Chou\n");
+}
+
+// DFS post order of the Aig gates in the PO and next-state cones,
+// with an explicit stack; PIs and latches end the cones
+void
+CirMgr::aigPostOrder(IdList& order) const
+{
+	MarkSet entered(_gateList.size()), done(_gateList.size());
+	vector<CirGate*> stack;
+	for(size_t i=0, n=_POList.size()+_LatchList.size(); i<n; i++){
+		stack.push_back(getGate(i < _POList.size()? _POList[i]: _LatchList[i-_POList.size()]));
+		while(!stack.empty()){
+			CirGate* temp = stack.back();
+			// a gate pushed again by another fanout before it was done;
+			// it is emitted once, by the copy that entered it
+			if(done.isMarked(temp->_gateID))	{ stack.pop_back();	continue; }
+			if(entered.isMarked(temp->_gateID)){
+				done.mark(temp->_gateID);
+				stack.pop_back();
+				if(temp->isAig())	order.push_back(temp->getGateID());
+				continue;
+			}
+			entered.mark(temp->_gateID);
+			for(size_t j=0, n=(temp->isAig()? 2: 1); j<n; j++){
+				CirGate* fanin = getGate(temp->faninLiteral(j)/2);
+				if(fanin && fanin->isAig() && !done.isMarked(fanin->_gateID))
+					stack.push_back(fanin);
+			}
+		}
+	}
+}
+
+// the Aig gates of _levelList; a floating fanin is CONST 0, whether
+// it is inverted or not, as in CirGate::getSimValue()
+void
+CirMgr::buildAig(CirAig& aig) const
+{
+	buildAig(aig, _levelList, false);
+}
+
+// the Aig gates of "order", in topological order (other gates in it are
+// skipped); if "floating", every undefined gate used as a fanin gets a
+// node of its own, else a floating fanin is CONST 0
+void
+CirMgr::buildAig(CirAig& aig, const IdList& order, bool floating) const
+{
+	aig._I = _I;	aig._L = _L;
+	aig._gateID.assign(1, 0);
+	aig._gateID.insert(aig._gateID.end(), _PIList.begin(), _PIList.end());
+	aig._gateID.insert(aig._gateID.end(), _LatchList.begin(), _LatchList.end());
+	vector<unsigned> node(_gateList.size(), 0);
+	for(size_t i=1; i<aig._gateID.size(); i++)	node[aig._gateID[i]] = i;
+	IdList floats, *f = (floating? &floats: 0);
+	aig._fanins.clear();
+	aig._fanins.reserve(order.size()*2);
+	for(size_t i=0; i<order.size(); i++){
+		const CirGate* temp = getGate(order[i]);
+		if(!temp->isAig())	continue;
+		node[order[i]] = aig._gateID.size();
+		aig._gateID.push_back(order[i]);
+		aig._fanins.push_back(aigLiteral(temp, 0, node, f));
+		aig._fanins.push_back(aigLiteral(temp, 1, node, f));
+	}
+	aig._next.resize(_L);
+	for(size_t i=0; i<_L; i++)
+		aig._next[i] = aigLiteral(getGate(_LatchList[i]), 0, node, f);
+	// the floating nodes come after the ANDs
+	aig._F = floats.size();
+	if(floats.empty())	return;
+	unsigned first = aig._gateID.size();
+	aig._gateID.insert(aig._gateID.end(), floats.begin(), floats.end());
+	for(size_t i=0; i<aig._fanins.size(); i++)
+		if(aig._fanins[i] & FLOAT_LIT)	aig._fanins[i] = first*2 + (aig._fanins[i] & ~FLOAT_LIT);
+	for(size_t i=0; i<_L; i++)
+		if(aig._next[i] & FLOAT_LIT)	aig._next[i] = first*2 + (aig._next[i] & ~FLOAT_LIT);
+}
+
+// the CirAig literal of fanin "i" of "gate", by node[] of the gate IDs;
+// a floating one is CONST 0 if there are no "floats", or else it is
+// FLOAT_LIT + its index in "floats"*2 (+1 if inverted), until the
+// floating nodes are numbered
+unsigned
+CirMgr::aigLiteral(const CirGate* gate, unsigned i, IdList& node, IdList* floats)
+{
+	const CirGate::CirGateSP& in = gate->_fanin[i];
+	if(!in.isFlt())	return node[in.gate()->_gateID]*2 + (in.isInv()? 1: 0);
+	if(!floats)	return 0;
+	unsigned id = in.literal()/2;
+	if(!node[id])	{ floats->push_back(id);	node[id] = floats->size(); }
+	return FLOAT_LIT + (node[id]-1)*2 + in.literal()%2;
+}
+
+void
+CirMgr::writeSymbols(OutBuf& out) const
+{
+	StrRef symbol;
 	for(size_t i=0; i<_PIList.size(); i++){
 		symbol = getSymb(_PIList[i]);
-		if(!symbol.empty()) outfile << "i" << i << " " << symbol << endl;
+		if(!symbol.empty()) out.put('i').putUInt(i).put(' ').put(symbol.data(), symbol.size()).put('\n');
+	}
+	for(size_t i=0; i<_LatchList.size(); i++){
+		symbol = getSymb(_LatchList[i]);
+		if(!symbol.empty()) out.put('l').putUInt(i).put(' ').put(symbol.data(), symbol.size()).put('\n');
 	}
 	for(size_t i=0; i<_POList.size(); i++){
 		symbol = getSymb(_POList[i]);
-		if(!symbol.empty()) outfile << "o" << i << " " << symbol << endl;
+		if(!symbol.empty()) out.put('o').putUInt(i).put(' ').put(symbol.data(), symbol.size()).put('\n');
 	}
-	outfile << "c" << endl;
-	outfile << "AAG output by Yun (Teresa) Chou" << endl;
 }
 
 void
@@ -352,13 +978,6 @@ CirMgr::writeGate(ostream& outfile, CirGate *g) const
 {
 }
 
-string
-CirMgr::getSymb(unsigned id) const
-{
-   map<unsigned, string>::const_iterator it = _symbolList.find(id);
-   if(it == _symbolList.end())	return "";
-   return it->second;
-}
  
 // run through all the gates to check for gates with floating inputs and gates unused
 // store them in two lists
@@ -375,6 +994,10 @@ CirMgr::setFloatingList(bool AigOnly)
 			temp = getGate(_POList[i]);
 			if(temp->floating())	_floatingList.push_back(_POList[i]);
 		}
+		for(size_t i=0; i<_LatchList.size(); i++){
+			temp = getGate(_LatchList[i]);
+			if(temp->floating())	_floatingList.push_back(_LatchList[i]);
+		}
 	}
 	::sort(_floatingList.begin(), _floatingList.end());
 }
@@ -388,6 +1011,10 @@ CirMgr::setUnUsedList(bool AigOnly)
 			temp = getGate(_PIList[i]);
 			if(temp->unUsed())	_unUsedList.push_back(_PIList[i]);
 		}
+		for(size_t i=0; i<_LatchList.size(); i++){
+			temp = getGate(_LatchList[i]);
+			if(temp->unUsed())	_unUsedList.push_back(_LatchList[i]);
+		}
 	}
 	for(size_t i=0; i<_AigList.size(); i++){
 		temp = getGate(_AigList[i]);
@@ -396,13 +1023,311 @@ CirMgr::setUnUsedList(bool AigOnly)
 	::sort(_unUsedList.begin(), _unUsedList.end());
 }
 
+// PO post order, then the next-state cones of the latches; the order
+// (and the levels) from the roots before "root" is kept as it is
 void
-CirMgr::setDFSList()
+CirMgr::setDFSList(size_t root)
 {
-	// PO post order
-	CirGate::_markFlagRef++;
-	for(size_t i=0; i<_POList.size(); i++){
-		getGate(_POList[i])->setDFSList_RC(_dfsList);	// CirGate member function
+	if(root > _dfsRootFirst.size())	root = 0;
+	size_t k = (root == 0? 0: root < _dfsRootFirst.size()? _dfsRootFirst[root]: _dfsList.size());
+	_dfsList.resize(k);
+	_dfsRootFirst.resize(root);
+	IdList levels(k);
+	MarkSet visited(_gateList.size());
+	for(size_t i=0; i<k; i++){
+		CirGate* temp = getGate(_dfsList[i]);
+		visited.mark(_dfsList[i]);
+		levels[i] = (temp->isAig()? temp->_level: 0);
+	}
+	for(size_t i=root; i<_POList.size()+_LatchList.size(); i++){
+		_dfsRootFirst.push_back(_dfsList.size());
+		if(i < _POList.size()){
+			dfsPostOrder(getGate(_POList[i]), visited, _dfsList, levels);
+			continue;
+		}
+		CirGate* latch = getGate(_LatchList[i-_POList.size()]);
+		if(!latch->_fanin[0].isFlt())	dfsPostOrder(latch->_fanin[0].gate(), visited, _dfsList, levels);
+		dfsPostOrder(latch, visited, _dfsList, levels);
+	}
+	setLevelList(levels);
+}
+
+// whether a gate (0 if removed) belongs to _floatingList/_unUsedList
+bool
+CirMgr::keepFloating(const CirGate* gate) { return (gate && gate->floating()); }
+
+bool
+CirMgr::keepUnUsed(const CirGate* gate)
+{
+	return (gate && gate->getType() != PO_GATE && gate->getType() != CONST_GATE
+	        && gate->unUsed());
+}
+
+// bring _floatingList, _unUsedList and, if "dfs", _dfsList with the
+// levels up to date with the gates changed by the command, without
+// going through all the gates
+void
+CirMgr::updateLists(bool dfs)
+{
+	updateList(_floatingList, _faninChanged, keepFloating);
+	updateList(_unUsedList, _fanoutChanged, keepUnUsed);
+	if(dfs)	updateDFSList();
+	_faninChanged.clear();
+	_fanoutChanged.clear();
+}
+
+// "list" (sorted) keeps the gates still to be kept, and gets the ones of
+// "changed" to be kept too; only the changed gates can have joined it
+void
+CirMgr::updateList(IdList& list, IdList& changed, bool (*keep)(const CirGate*))
+{
+	size_t k = 0;
+	for(size_t i=0; i<list.size(); i++)
+		if(keep(getGate(list[i])))	list[k++] = list[i];
+	list.resize(k);
+	::sort(changed.begin(), changed.end());
+	for(size_t i=0; i<changed.size(); i++){
+		if(i && changed[i] == changed[i-1])	continue;
+		if(keep(getGate(changed[i])) && !binary_search(list.begin(), list.begin()+k, changed[i]))
+			list.push_back(changed[i]);
+	}
+	inplace_merge(list.begin(), list.begin()+k, list.end());
+}
+
+// only the cones with a removed gate or a gate with changed fanins have
+// a different order; the DFS is redone from the first root of such a
+// cone, as the roots before it would give the same order again
+void
+CirMgr::updateDFSList()
+{
+	if(_faninChanged.empty())	return;
+	if(_dfsRootFirst.size() != _POList.size()+_LatchList.size()){
+		setDFSList();
+		return;
+	}
+	MarkSet changed(_gateList.size());
+	for(size_t i=0; i<_faninChanged.size(); i++)	changed.mark(_faninChanged[i]);
+	size_t p = 0;
+	for(; p<_dfsList.size(); p++)
+		if(!getGate(_dfsList[p]) || changed.isMarked(_dfsList[p]))	break;
+	if(p == _dfsList.size())	return;
+	setDFSList(upper_bound(_dfsRootFirst.begin(), _dfsRootFirst.end(), p)
+	           - _dfsRootFirst.begin() - 1);
+}
+
+// the gates of the cone of "root" not in "visited" yet, in DFS post
+// order, with an explicit stack; a latch ends the cone. A gate is marked when
+// it is entered, so a loop (e.g. from merging) is cut, not followed.
+// The level of a gate is set as it is put in the order; "levels" gets
+// it too, for an Aig gate, or 0
+void
+CirMgr::dfsPostOrder(CirGate* root, MarkSet& visited, IdList& order, IdList& levels) const
+{
+	if(!visited.markNew(root->_gateID))	return;
+	vector<DFSFrame> stack(1, DFSFrame(root));
+	while(!stack.empty()){
+		DFSFrame& f = stack.back();
+		CirGate* temp = f._gate;
+		CirGate* fanin = 0;
+		for(; f._next < f._num; f._next++){
+			if(temp->_fanin[f._next].isFlt())	continue;
+			fanin = temp->_fanin[f._next].gate();
+			if(!visited.isMarked(fanin->_gateID))	break;
+			if(f._level < fanin->_level)	f._level = fanin->_level;
+		}
+		if(f._next == f._num){
+			unsigned level = temp->_level = (f._aig? f._level+1: f._level);
+			order.push_back(temp->_gateID);
+			levels.push_back(f._aig? level: 0);
+			stack.pop_back();
+			if(!stack.empty() && stack.back()._level < level)	stack.back()._level = level;
+			continue;
+		}
+		f._next++;
+		visited.mark(fanin->_gateID);
+		stack.push_back(DFSFrame(fanin));
+	}
+}
+
+// from the levels of the first "n" fanins (none for a latch); a PO is
+// at the level of its fanin
+unsigned
+CirMgr::setLevel(CirGate* gate, unsigned n, bool aig)
+{
+	unsigned level = 0;
+	for(unsigned i=0; i<n; i++)
+		if(!gate->_fanin[i].isFlt() && level < gate->_fanin[i].gate()->_level)
+			level = gate->_fanin[i].gate()->_level;
+	gate->_level = (aig? level+1: level);
+	return gate->_level;
+}
+
+// the levels of the gates of _dfsList, which is in topological order
+void
+CirMgr::setLevelList()
+{
+	IdList levels(_dfsList.size());
+	for(size_t i=0; i<_dfsList.size(); i++){
+		CirGate* temp = getGate(_dfsList[i]);
+		bool aig = temp->isAig();
+		unsigned level = setLevel(temp, (temp->isLatch()? 0: temp->_fanin.size()), aig);
+		levels[i] = (aig? level: 0);
+	}
+	setLevelList(levels);
+}
+
+// the Aig gates of _dfsList bucketed by level (stable within a level);
+// levels[i] is the level of _dfsList[i] if it is an Aig gate, or 0
+void
+CirMgr::setLevelList(const IdList& levels)
+{
+	unsigned maxLevel = 0;
+	for(size_t i=0; i<levels.size(); i++)
+		if(levels[i] > maxLevel)	maxLevel = levels[i];
+	_levelFirst.assign(maxLevel+2, 0);
+	for(size_t i=0; i<levels.size(); i++)
+		if(levels[i])	_levelFirst[levels[i]+1]++;
+	for(size_t l=1; l<_levelFirst.size(); l++)	_levelFirst[l] += _levelFirst[l-1];
+	_levelList.resize(_levelFirst.back());
+	IdList next(_levelFirst);
+	for(size_t i=0; i<levels.size(); i++)
+		if(levels[i])	_levelList[next[levels[i]]++] = _dfsList[i];
+}
+
+// drop the removed gates from _dfsList and _levelList, moving the starts
+// of the cones in _dfsRootFirst; the rest stays in order, which is what
+// setDFSList() would give after strash() merges (the host comes first
+// and has the fanins and the level of the other)
+void
+CirMgr::compactDFSList()
+{
+	size_t k = 0, r = 0;
+	for(size_t i=0; i<_dfsList.size(); i++){
+		for(; r<_dfsRootFirst.size() && _dfsRootFirst[r] == i; r++)	_dfsRootFirst[r] = k;
+		if(getGate(_dfsList[i]))	_dfsList[k++] = _dfsList[i];
+	}
+	for(; r<_dfsRootFirst.size(); r++)	_dfsRootFirst[r] = k;
+	_dfsList.resize(k);
+	k = 0;
+	for(size_t l=0; l+1<_levelFirst.size(); l++){
+		size_t first = k;
+		for(size_t i=_levelFirst[l]; i<_levelFirst[l+1]; i++)
+			if(getGate(_levelList[i]))	_levelList[k++] = _levelList[i];
+		_levelFirst[l] = first;
+	}
+	if(!_levelFirst.empty())	_levelFirst.back() = k;
+	_levelList.resize(k);
+}
+
+// memory for a gate of any type, to be constructed by placement new;
+// freeGate() gives it back
+void*
+CirMgr::allocGate()
+{
+	if(!_gatePool){
+		size_t s = sizeof(AigGate);
+		if(s < sizeof(PIGate))	s = sizeof(PIGate);
+		if(s < sizeof(POGate))	s = sizeof(POGate);
+		if(s < sizeof(LatchGate))	s = sizeof(LatchGate);
+		if(s < sizeof(ConstGate))	s = sizeof(ConstGate);
+		_gatePool = new MemPool(s);
+	}
+	return _gatePool->alloc();
+}
+
+// between commands the gates own no memory outside of _gatePool (the
+// fanins are in the gates and the fanouts in _fanouts), so they are
+// released with the pool, without visiting them one by one
+void
+CirMgr::deleteGates()
+{
+	if(_FECList){
+		for(size_t i=0; i<_FECList->size(); i++)	delete (*_FECList)[i];
+		delete _FECList;
+		_FECList = 0;
+	}
+	vector<CirGate*>().swap(_gateList);
+	delete _gatePool;
+	_gatePool = 0;
+	delete _fanouts;
+	_fanouts = 0;
+}
+
+// the fanouts of every gate from the fanins of all the gates, sorted by
+// literal as addFanout() keeps them: the sinks are visited in the order
+// of IDs, so a slice only has to skip a sink that uses a gate twice
+void
+CirMgr::buildFanouts()
+{
+	size_t n = _gateList.size();
+	vector<unsigned> first(n+1, 0);
+	for(size_t i=0; i<n; i++){
+		CirGate* temp = _gateList[i];
+		if(!temp)	continue;
+		for(size_t j=0; j<temp->_fanin.size(); j++)
+			if(!temp->_fanin[j].isFlt())	first[temp->_fanin[j].gate()->_gateID + 1]++;
+	}
+	for(size_t i=0; i<n; i++)	first[i+1] += first[i];
+	if(!_fanouts)	_fanouts = new CirFanouts;
+	vector<CirGate::CirGateSP>& list = _fanouts->_list;
+	list.assign(first[n], CirGate::CirGateSP((size_t)0));
+	vector<unsigned> last(first.begin(), first.end()-1);
+	for(size_t i=0; i<n; i++){
+		CirGate* temp = _gateList[i];
+		if(!temp)	continue;
+		for(size_t j=0; j<temp->_fanin.size(); j++){
+			const CirGate::CirGateSP& in = temp->_fanin[j];
+			if(in.isFlt())	continue;
+			unsigned id = in.gate()->_gateID;
+			CirGate::CirGateSP out(temp, in.isInv());
+			if(last[id] == first[id] || !(list[last[id]-1] == out))	list[last[id]++] = out;
+		}
+	}
+	for(size_t i=0; i<n; i++){
+		CirGate* temp = _gateList[i];
+		if(!temp)	continue;
+		temp->_foList = (list.empty()? 0: &list[0] + first[i]);
+		temp->_foNum = last[i] - first[i];
+		delete temp->_foSet;
+		temp->_foSet = 0;
+	}
+}
+
+// fold the fanouts changed by a command back into one CSR
+void
+CirMgr::rebuildFanouts()
+{
+	size_t n = 0;
+	bool changed = false;
+	for(size_t i=0; i<_gateList.size(); i++){
+		CirGate* temp = _gateList[i];
+		if(!temp)	continue;
+		if(temp->_foSet)	{ n += temp->_foSet->size();	changed = true; }
+		else	n += temp->_foNum;
+	}
+	if(!changed)	return;
+	vector<CirGate::CirGateSP> list, fanouts;
+	list.reserve(n);
+	for(size_t i=0; i<_gateList.size(); i++){
+		CirGate* temp = _gateList[i];
+		if(!temp)	continue;
+		if(temp->_foSet){
+			temp->getFanouts(fanouts);
+			::sort(fanouts.begin(), fanouts.end());
+			list.insert(list.end(), fanouts.begin(), fanouts.end());
+			temp->_foNum = fanouts.size();
+			delete temp->_foSet;
+			temp->_foSet = 0;
+		}
+		else	list.insert(list.end(), temp->_foList, temp->_foList + temp->_foNum);
+	}
+	_fanouts->_list.swap(list);
+	size_t k = 0;
+	for(size_t i=0; i<_gateList.size(); i++){
+		CirGate* temp = _gateList[i];
+		if(!temp)	continue;
+		temp->_foList = (_fanouts->_list.empty()? 0: &_fanouts->_list[0] + k);
+		k += temp->_foNum;
 	}
 }
 
@@ -20,14 +20,22 @@ using namespace std;
 // TODO: Feel free to define your own classes, variables, or functions.
 
 #include "cirDef.h"
+#include "myMarkSet.h"
+#include "myStrPool.h"
 
 extern CirMgr *cirMgr;
 
+class InFile;
+class OutBuf;
+class CirAig;
+class CirFanouts;
+class MemPool;
+
 class CirMgr
 {
 public:
-   CirMgr() {}
-   ~CirMgr() {} 
+   CirMgr(): _simLog(0), _fanouts(0), _gatePool(0), _FECList(0) {}
+   ~CirMgr() { deleteGates(); }
 
    // Access functions
    // return '0' if "gid" corresponds to an undefined gate.
@@ -37,14 +45,17 @@ public:
 		if(it == _gateList.end())	return 0;
 		return it->second;
       */
-      ID key(gid);
-      CirGate* result;
-      if(_gateList.query(key, result))   return result;
-      return 0;
+      return (gid < _gateList.size())? _gateList[gid]: 0;
 	}
 
    // Member functions about circuit construction
    bool readCircuit(const string&);
+   bool readMiter(const string& golden, const string& revised);
+
+   // Member functions about netlist snapshots
+   // "state" is kept for the caller (e.g. the command state)
+   bool saveSnapshot(const string&, unsigned state) const;
+   bool loadSnapshot(const string&, unsigned& state);
 
    // Member functions about circuit optimization
    void sweep();
@@ -53,13 +64,14 @@ public:
    // Member functions about simulation
    bool FECReady() const { return _FECReady; }
    void randomSim();
-   void fileSim(ifstream&);
-   void setSimLog(ofstream *logFile) { _simLog = logFile; }
+   void fileSim(InFile&);
+   void seqSim(unsigned cycles);
+   void setSimLog(ofstream *logFile);
 
    // Member functions about fraig
-   void strash();
+   void strash(bool stats = false);
    void printFEC() const;
-   void fraig();
+   void fraig(bool stats = false, bool cache = true);
 
    // Member functions about circuit reporting
    void printSummary() const;
@@ -69,21 +81,48 @@ public:
    void printFloatGates() const;
    void printFECPairs() const;
    void writeAag(ostream&) const;
+   void writeAig(ostream&) const;
    void writeGate(ostream&, CirGate*) const;
    
    // other helping functions
-	string getSymb(unsigned id) const;
+	// empty if none; good until the symbols change
+	StrRef getSymb(unsigned id) const { return _symbolList[id]; }
 
 private:
    // basic helping functions
+   void writeSymbols(OutBuf&) const;
+   void aigPostOrder(IdList&) const;
+   void buildAig(CirAig&) const;
+   void buildAig(CirAig&, const IdList& order, bool floating) const;
+   static unsigned aigLiteral(const CirGate*, unsigned i, IdList& node, IdList* floats);
+   void* allocGate();
    bool freeGate(unsigned id, CirGate* target);
+   void deleteGates();
    bool removeFromAigList(unsigned id);
+   void compactAigList();
 	void setFloatingList(bool AigOnly = false);
 	void setUnUsedList(bool AigOnly = false);
-   void setDFSList();
+   void setDFSList(size_t root = 0);
+   void updateLists(bool dfs);
+   void updateList(IdList& list, IdList& changed, bool (*keep)(const CirGate*));
+   static bool keepFloating(const CirGate*);
+   static bool keepUnUsed(const CirGate*);
+   void updateDFSList();
+   void dfsPostOrder(CirGate* root, MarkSet& visited, IdList& order, IdList& levels) const;
+   static unsigned setLevel(CirGate*, unsigned n, bool aig);
+   void setLevelList();
+   void setLevelList(const IdList& levels);
+   void compactDFSList();
+   void buildFanouts();
+   void rebuildFanouts();
+   bool readAigsParallel(const char*& p, const char* end, unsigned nTasks);
+   void connectLinksParallel(unsigned nTasks);
+   static void linkTask(void* arg, unsigned task, unsigned nTasks);
+   static CirMgr* readSource(const string&);
+   void buildMiter(const CirMgr& golden, const CirMgr& revised,
+                   const vector<unsigned>& piOrder, const vector<unsigned>& poOrder);
 
    // functions for optimizing and fraig
-	bool removeGate(unsigned id);
 	bool mergeGate(CirGate* from, CirGate* to);
    void genProofModel(SatSolver& sat);
    bool proveSat(SatSolver& sat, CirGate* gateA, CirGate* gateB, unsigned* sample);
@@ -92,16 +131,34 @@ private:
    void initFEC();
    bool divideFEC();
    bool simulate(unsigned* inputs);
+   bool simulate(const CirAig&, vector<unsigned>& value, unsigned* inputs);
    bool writeSimLog(unsigned * inputs, unsigned n = sizeof(unsigned)*8);
 
-   ofstream				        *_simLog;
-	HashMap<ID, CirGate*>		_gateList;
-	map<unsigned, string>		_symbolList;
+   OutBuf                    *_simLog;
+	vector<CirGate*>				_gateList;	// by gate ID; 0 if none
+   CirFanouts                *_fanouts;
+   MemPool                   *_gatePool;  // all the gates are in it
+	StrPool							_symbolList;	// by gate ID
    vector<FECGrp*>           *_FECList;
    bool                       _FECReady;
-	unsigned							_M, _I, _L, _O, _A;
-	IdList							_PIList, _POList, _AigList;
+   MarkSet                    _simFed;     // gates with _value of the last patterns
+   // the SAT verdicts (true: SAT, i.e. not equivalent) of fraig(), kept
+   // for the later calls; empty until the first one
+   Cache<ProofKey, bool>      _proofCache;
+	unsigned							_M, _I, _L, _O, _A;	// _A: AIGs left
+	// within sweep/optimize/strash, _AigList also has the IDs of the
+	// removed AIGs, until compactAigList()
+	IdList							_PIList, _POList, _AigList, _LatchList;
    IdList                     _floatingList, _unUsedList, _dfsList;
+   // the Aig gates of _dfsList by level; level l is
+   // _levelList[_levelFirst[l]] .. _levelList[_levelFirst[l+1]-1]
+   IdList                     _levelList, _levelFirst;
+   // where the cone of each root (the POs, then the latches) starts in
+   // _dfsList; empty if unknown (e.g. after loadSnapshot())
+   IdList                     _dfsRootFirst;
+   // the gates whose fanins/fanouts are changed by the current command,
+   // as recorded by freeGate(); updateLists() works from them
+   IdList                     _faninChanged, _fanoutChanged;
 };
 
 #endif // CIR_MGR_H
@@ -0,0 +1,234 @@
+/****************************************************************************
+  FileName     [ cirMiter.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define miter construction for equivalence checking ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <new>
+#include <cassert>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+
+using namespace std;
+
+// A miter of a golden and a revised circuit has the PIs of both (shared)
+// and one PO per pair of POs, which is the XOR of the two. The two
+// circuits are equivalent iff every PO of the miter is constant 0, which
+// strash(), simulation and fraig() can find out on the miter itself.
+//
+// Ports are paired by their symbolic names if every one of them has a
+// distinct name in both circuits, and by their positions otherwise.
+// Only the AIGs in the PO cones are copied; they are structurally
+// hashed while they are created, so the logic shared by the two
+// circuits appears only once.
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+class MiterKey
+{
+public:
+   MiterKey(unsigned a = 0, unsigned b = 0): _a(a), _b(b) {}
+
+   size_t operator() () const { return ((size_t)_a << 16) ^ _b; }
+   bool operator== (const MiterKey& k) const { return (k._a == _a && k._b == _b); }
+
+private:
+   unsigned _a, _b;
+};
+
+typedef FlatHashMap<MiterKey, unsigned> MiterHash;
+
+// the miter literal of the source literal "a", by lit[] of its variables;
+// a floating one is constant 0 even if inverted, as in simulation,
+// CirAig, fraig and CIRWrite
+static unsigned
+miterLiteral(const CirMgr& source, const vector<unsigned>& lit, unsigned a)
+{
+   return (source.getGate(a/2)? lit[a/2] ^ (a%2): 0);
+}
+
+// the literal of (a & b) in the miter being built; the AIG vars start
+// from "firstVar" and "fanins" has two literals for each of them
+static unsigned
+miterAnd(unsigned a, unsigned b, unsigned firstVar, IdList& fanins, MiterHash& hash)
+{
+   if(a > b)   { unsigned t = a;   a = b;   b = t; }
+   if(a == 0 || a == (b^1))   return 0;
+   if(a == 1 || a == b)   return b;
+   unsigned lit;
+   if(hash.query(MiterKey(a, b), lit))   return lit;
+   lit = (firstVar + fanins.size()/2)*2;
+   fanins.push_back(a);
+   fanins.push_back(b);
+   hash.insert(MiterKey(a, b), lit);
+   return lit;
+}
+
+// order[j] is the golden port paired with the j-th revised port, by
+// name if every port is named and the names pair up one to one, or
+// else in order. A revised name is looked up among the golden symbols;
+// if two golden ports share it, the same one is always found, so the
+// other is left unpaired and the names are not used.
+static void
+matchPorts(const StrPool& gSymbols, const IdList& gPorts,
+           const StrPool& rSymbols, const IdList& rPorts, vector<unsigned>& order)
+{
+   assert(gPorts.size() == rPorts.size());
+   size_t n = gPorts.size();
+   order.resize(n);
+   // the golden port of each gate ID, or n
+   IdList pos;
+   for(size_t i=0; i<n; i++){
+      if(gPorts[i] >= pos.size())   pos.resize(gPorts[i]+1, n);
+      pos[gPorts[i]] = i;
+   }
+   vector<bool> used(n, false);
+   bool byName = true;
+   for(size_t j=0; j<n && byName; j++){
+      StrRef name = rSymbols[rPorts[j]];
+      unsigned id = (name.empty()? StrPool::NO_ID: gSymbols.find(name));
+      for(; id != StrPool::NO_ID; id = gSymbols.find(name, id))
+         if(id < pos.size() && pos[id] != n)   break;
+      if(id == StrPool::NO_ID || used[pos[id]])   byName = false;
+      else { order[j] = pos[id];   used[pos[id]] = true; }
+   }
+   if(!byName)
+      for(size_t j=0; j<n; j++)   order[j] = j;
+}
+
+/**************************************************************/
+/*   class CirMgr member functions for miter construction     */
+/**************************************************************/
+// as readCircuit(), this has to be cirMgr, for the gates are linked
+// through cirMgr
+bool
+CirMgr::readMiter(const string& goldenFile, const string& revisedFile)
+{
+   CirMgr* golden = readSource(goldenFile);
+   if(!golden)   return false;
+   CirMgr* revised = readSource(revisedFile);
+   if(!revised)   { delete golden;   return false; }
+
+   bool ok = false;
+   if(golden->_L || revised->_L)
+      cerr << "Error: \"" << (golden->_L? goldenFile: revisedFile)
+           << "\" has latches; a miter is for combinational circuits!!" << endl;
+   else if(golden->_I != revised->_I)
+      cerr << "Error: numbers of PIs do not match (" << golden->_I << " vs "
+           << revised->_I << ")!!" << endl;
+   else if(golden->_O != revised->_O)
+      cerr << "Error: numbers of POs do not match (" << golden->_O << " vs "
+           << revised->_O << ")!!" << endl;
+   else {
+      vector<unsigned> piOrder, poOrder;
+      matchPorts(golden->_symbolList, golden->_PIList,
+                 revised->_symbolList, revised->_PIList, piOrder);
+      matchPorts(golden->_symbolList, golden->_POList,
+                 revised->_symbolList, revised->_POList, poOrder);
+      buildMiter(*golden, *revised, piOrder, poOrder);
+      ok = true;
+   }
+   delete golden;
+   delete revised;
+   return ok;
+}
+
+/**********************************************************/
+/*   class CirMgr member functions for miter helpers     */
+/**********************************************************/
+// read a source circuit of the miter into a new CirMgr;
+// cirMgr points to it while its gates are linked
+CirMgr*
+CirMgr::readSource(const string& fileName)
+{
+   CirMgr* miter = cirMgr;
+   CirMgr* source = cirMgr = new CirMgr;
+   bool ok = source->readCircuit(fileName);
+   cirMgr = miter;
+   if(ok)   return source;
+   delete source;
+   return 0;
+}
+
+// the miter is numbered as if it was read from an aag file:
+// PIs 1.._I, then the AIGs in topological order, then the POs,
+// with the line numbers of such a file
+void
+CirMgr::buildMiter(const CirMgr& golden, const CirMgr& revised,
+                   const vector<unsigned>& piOrder, const vector<unsigned>& poOrder)
+{
+   _I = golden._I;   _L = 0;   _O = golden._O;
+   MiterHash hash(golden._A + revised._A + _O*3);
+   IdList fanins;
+   vector<unsigned> outs[2];
+   for(size_t s=0; s<2; s++){
+      const CirMgr& source = (s? revised: golden);
+      // miter literal of each variable
+      vector<unsigned> lit(source._M + 1, 0);
+      for(size_t i=0; i<_I; i++)
+         lit[source._PIList[i]] = (s? piOrder[i]: i)*2 + 2;
+      IdList order;
+      source.aigPostOrder(order);
+      for(size_t i=0; i<order.size(); i++){
+         CirGate* temp = source.getGate(order[i]);
+         unsigned a = temp->faninLiteral(0), b = temp->faninLiteral(1);
+         lit[order[i]] = miterAnd(miterLiteral(source, lit, a), miterLiteral(source, lit, b),
+                                 _I+1, fanins, hash);
+      }
+      outs[s].resize(_O);
+      for(size_t i=0; i<_O; i++){
+         unsigned a = source.getGate(source._POList[i])->faninLiteral(0);
+         outs[s][s? poOrder[i]: i] = miterLiteral(source, lit, a);
+      }
+   }
+   // a ^ b = !(!(a & !b) & !(!a & b))
+   for(size_t i=0; i<_O; i++){
+      unsigned a = outs[0][i], b = outs[1][i];
+      unsigned x = miterAnd(a, b^1, _I+1, fanins, hash);
+      unsigned y = miterAnd(a^1, b, _I+1, fanins, hash);
+      outs[0][i] = miterAnd(x^1, y^1, _I+1, fanins, hash) ^ 1;
+   }
+   _A = fanins.size()/2;
+   _M = _I + _A;
+
+   // gates, as in readCircuit()
+   _gateList.assign(_M+_O+1, 0);
+   _FECList = new vector<FECGrp*>;
+   _FECReady = false;
+   _PIList.reserve(_I);   _POList.reserve(_O);   _AigList.reserve(_A);
+   _gateList[0] = new(allocGate()) ConstGate;
+   for(unsigned i=0; i<_I; i++){
+      _gateList[i+1] = new(allocGate()) PIGate(i+1, i+2);
+      _PIList.push_back(i+1);
+      StrRef symbol = golden.getSymb(golden._PIList[i]);
+      if(!symbol.empty())   _symbolList.insert(i+1, symbol);
+   }
+   for(unsigned i=0; i<_A; i++){
+      unsigned id = _I+1+i;
+      _gateList[id] = new(allocGate()) AigGate(id, _I+_O+i+2, fanins[i*2], fanins[i*2+1]);
+      _AigList.push_back(id);
+   }
+   for(unsigned i=0; i<_O; i++){
+      unsigned id = _M+1+i;
+      _gateList[id] = new(allocGate()) POGate(id, _I+i+2, outs[0][i]);
+      _POList.push_back(id);
+      StrRef symbol = golden.getSymb(golden._POList[i]);
+      if(!symbol.empty())   _symbolList.insert(id, symbol);
+   }
+   for(unsigned i=0; i<_A; i++)   getGate(_AigList[i])->connectLinks();
+   for(unsigned i=0; i<_O; i++)   getGate(_POList[i])->connectLinks();
+   buildFanouts();
+
+	setFloatingList();
+	setUnUsedList();
+   setDFSList();
+}
@@ -11,6 +11,7 @@
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
+#include "myMemPool.h"
 
 using namespace std;
 
@@ -31,29 +32,63 @@ using namespace std;
 // Remove unused gates
 // DFS list should NOT be changed
 // UNDEF, float and unused list may be changed
+//
+// The unused AIGs go in rounds, as each of them was removed one by one:
+// the first round is the AIGs of _unUsedList, and a fanin of a round
+// is in the next round once all its fanouts have been removed. Only the
+// marks change on the way; the gates are freed at the end, and the
+// fanouts are built again in their CSR.
 void
 CirMgr::sweep()
 {
-	bool clear = false;
-	while(!clear){
-		clear = true;
-		for(vector<unsigned>::iterator it=_unUsedList.begin(); it!=_unUsedList.end(); ) {
-			if(removeGate(*it)){	
-				_unUsedList.erase(it);
-				clear = false;
+	MarkSet removed(_gateList.size());
+	IdList round, next, gone;
+	vector<CirGate::CirGateSP> fanouts;
+	for(size_t i=0; i<_unUsedList.size(); i++){
+		CirGate* temp = getGate(_unUsedList[i]);
+		if(temp && temp->isAig())	round.push_back(_unUsedList[i]);
+	}
+	while(!round.empty()){
+		for(size_t i=0; i<round.size(); i++){
+			removed.mark(round[i]);
+			cout << "Sweeping: AIG(" << round[i] << ") removed..." << endl;
+		}
+		next.clear();
+		for(size_t i=0; i<round.size(); i++){
+			CirGate* temp = getGate(round[i]);
+			for(size_t j=0; j<temp->_fanin.size(); j++){
+				if(temp->_fanin[j].isFlt())	continue;
+				CirGate* fanin = temp->_fanin[j].gate();
+				_fanoutChanged.push_back(fanin->_gateID);
+				if(!fanin->isAig() || removed.isMarked(fanin->_gateID))	continue;
+				fanin->getFanouts(fanouts);
+				size_t k = 0;
+				for(; k<fanouts.size(); k++)
+					if(!removed.isMarked(fanouts[k].gate()->_gateID))	break;
+				if(k == fanouts.size())	next.push_back(fanin->_gateID);
 			}
-			else it++;
 		}
-		setUnUsedList(true);
+		::sort(next.begin(), next.end());
+		next.erase(unique(next.begin(), next.end()), next.end());
+		gone.insert(gone.end(), round.begin(), round.end());
+		round.swap(next);
 	}
-   _unUsedList.clear();
-   setUnUsedList();
-	_floatingList.clear();
-	setFloatingList();
+	// the fanouts of a removed gate are all removed, so only its fanins
+	// are changed
+	for(size_t i=0; i<gone.size(); i++){
+		CirGate* temp = getGate(gone[i]);
+		removeFromAigList(gone[i]);
+		_gateList[gone[i]] = 0;
+		temp->~CirGate();
+		_gatePool->free(temp);
+	}
+	compactAigList();
+	if(!gone.empty())	buildFanouts();
+	updateLists(false);
 }
 
 // Recursively simplifying from POs;
-// _dfsList needs to be reconstructed afterwards
+// _dfsList is redone from the first cone with a change
 // UNDEF gates may be delete if its fanout becomes empty...
 // 1. CONST 1 AND X = X
 // 2. CONST 0 AND X = 0
@@ -77,73 +112,78 @@ CirMgr::optimize()
       }
       freeGate(_dfsList[i], target);
    }
-   _unUsedList.clear();
-   setUnUsedList();
-	_floatingList.clear();
-	setFloatingList();
-   _dfsList.clear();
-   setDFSList();
+   compactAigList();
+   updateLists(true);
+   rebuildFanouts();
 }
 
 /***************************************************/
 /*   Private member functions about optimization   */
 /***************************************************/
 
-// for sweeping
-// remove unused gates
-bool
-CirMgr::removeGate(unsigned id)
-{
-	CirGate* target = getGate(id);
-   if(target == 0)   return false;
-	if(!target->isAig())	return false;
-	target->clearFanin();
-   freeGate(id, target);
-	cout << "Sweeping: AIG(" << id << ") removed..." << endl;
-	return true;
-}
-
-
+// the fanouts of the gate have had their fanins changed, and its fanins
+// have lost it as a fanout; they are kept for updateLists()
 bool
 CirMgr::freeGate(unsigned id, CirGate* target)
 {
    if(target == 0)   return false;
+   vector<CirGate::CirGateSP> fanouts;
+   target->getFanouts(fanouts);
+   for(size_t i=0; i<fanouts.size(); i++)
+      _faninChanged.push_back(fanouts[i].gate()->_gateID);
+   for(size_t i=0; i<target->_fanin.size(); i++)
+      if(!target->_fanin[i].isFlt())
+         _fanoutChanged.push_back(target->_fanin[i].gate()->_gateID);
    removeFromAigList(id);
-   _gateList.remove(id);
-   delete target;
+   _gateList[id] = 0;
+   target->~CirGate();
+   _gatePool->free(target);
    return true;
 }
 
+// the ID stays in _AigList until compactAigList(); it is known to be
+// removed since its gate is no longer in _gateList
 bool
 CirMgr::removeFromAigList(unsigned id)
 {
-	for(vector<unsigned>::iterator it = _AigList.begin(); it!=_AigList.end(); it++)
-		if(*it == id)	{
-         _AigList.erase(it);
-         _A--;
-         return true;
-      }
-   return false;
+   CirGate* target = getGate(id);
+   if(target == 0 || !target->isAig())   return false;
+   _A--;
+   return true;
+}
+
+// drop the IDs of the removed gates from _AigList, in one pass
+void
+CirMgr::compactAigList()
+{
+   if(_AigList.size() == _A)   return;
+   size_t k = 0;
+   for(size_t i=0; i<_AigList.size(); i++)
+      if(getGate(_AigList[i]))   _AigList[k++] = _AigList[i];
+   _AigList.resize(k);
 }
 
 
+// "inv": this gate is the inverse of "host"
 void
-CirGate::mergeInto(CirGate* host)
+CirGate::mergeInto(CirGate* host, bool inv)
 {
 	unsigned sign;
 	CirGateSP from(0), to(0);
-	for(vector<CirGateSP>::iterator it = _fanin.begin(); it!=_fanin.end(); it++) {
+	for(CirFanins::iterator it = _fanin.begin(); it!=_fanin.end(); it++) {
       if(it->isFlt())   continue;
 		sign = it->isInv()? 1: 0;
 		from = CirGateSP(this, sign);
 		it->gate()->delFanout(from);
 	}
-	for(vector<CirGateSP>::iterator it = _fanout.begin(); it!=_fanout.end(); it++) {
+	vector<CirGateSP> fanouts;
+	getFanouts(fanouts);
+	for(vector<CirGateSP>::iterator it = fanouts.begin(); it!=fanouts.end(); it++) {
 		sign = it->isInv()? 1: 0;
 		from = CirGateSP(this, sign);
-		to = CirGateSP(host, sign);
+		to = CirGateSP(host, sign ^ inv);
 		it->gate()->changeFanin(from, to);
-		host->addFanout(*it);
+		host->addFanout(CirGateSP(it->gate(), sign ^ inv));
 	}
 }
 
@@ -152,7 +192,9 @@ CirGate::replaceByConst(CirGate* gate, unsigned sign)
 {
    CirGateSP input(gate, sign);
    clearFanin();
-	for(vector<CirGateSP>::iterator it = _fanout.begin(); it!=_fanout.end(); it++) {
+	vector<CirGateSP> fanouts;
+	getFanouts(fanouts);
+	for(vector<CirGateSP>::iterator it = fanouts.begin(); it!=fanouts.end(); it++) {
       sign = it->isInv()? 1: 0;
       it->gate()->changeFanin(CirGateSP(this, sign), input);
    }
@@ -167,7 +209,9 @@ CirGate::replaceByFanin(unsigned number)
    bool sign_in = _fanin[number].isInv();
    CirGateSP to(0);
    clearFanin();
-	for(vector<CirGateSP>::iterator it = _fanout.begin(); it!=_fanout.end(); it++) {
+	vector<CirGateSP> fanouts;
+	getFanouts(fanouts);
+	for(vector<CirGateSP>::iterator it = fanouts.begin(); it!=fanouts.end(); it++) {
       sign = it->isInv()? 1: 0;
       if(sign_in) {
          _fanin[number].gate()->addFanout(CirGateSP(it->gate(), (sign+1)%2));
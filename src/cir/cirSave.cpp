@@ -0,0 +1,410 @@
+/****************************************************************************
+  FileName     [ cirSave.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define cir netlist snapshot functions ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <new>
+#include <fstream>
+#include <cstring>
+#include <climits>
+#include "cirMgr.h"
+#include "cirGate.h"
+#include "util.h"
+#include "myInFile.h"
+#include "myOutBuf.h"
+
+using namespace std;
+
+// A snapshot is the in-memory netlist dumped as arrays of 32-bit words
+// (host byte order), so that a reload does not parse, connect, sort or
+// traverse anything:
+//
+//   header  : SNAP_HEADER words, see SnapField
+//   gates   : (id, line) of CONST, PIs, latches, POs and AIGs, in this
+//             order (each as in _PIList/_LatchList/_POList/_AigList)
+//   values  : last simulation value of each gate, in the same order;
+//             0 for the gates that are not in _simFed
+//   fed     : the gates in _simFed, 1 bit each in the same order
+//             (bit i%32 of word i/32)
+//   fanins  : 1 literal per latch and per PO, then 2 literals per AIG
+//   fanouts : CSR offsets (one per gate + 1), then fanout literals
+//   lists   : floating, unused and DFS gate IDs
+//   symbols : (id, offset) pairs, then the null-terminated names
+//   FECs    : group offsets (one per group + 1), then member IDs
+//
+// A literal that refers to a non-existing gate is a floating fanin.
+// Any change of the layout must bump SNAP_VERSION.
+//
+// A snapshot is checked as a whole before anything is allocated: the
+// sections must add up to the size of the file, every ID and offset must
+// be in range, and a fanout, list member, symbol or FEC member must be an
+// existing gate.
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+enum SnapField
+{
+   SNAP_MAGIC,
+   SNAP_VER,
+   SNAP_WORDS,       // total size of the image in words
+   SNAP_STATE,
+   SNAP_M, SNAP_I, SNAP_L, SNAP_O, SNAP_A,
+   SNAP_FEC_READY,
+   SNAP_FANOUTS,     // number of fanout literals
+   SNAP_FLOATING,
+   SNAP_UNUSED,
+   SNAP_DFS,
+   SNAP_SYMBOLS,
+   SNAP_SYMBOL_WORDS,
+   SNAP_FECS,
+   SNAP_FEC_MEMBERS,
+
+   SNAP_HEADER
+};
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const unsigned SNAP_MAGIC_NUM = 0x53524943;  // "CIRS"
+static const unsigned SNAP_VERSION = 3;
+
+static inline void
+putWords(OutBuf& out, const unsigned* w, size_t n)
+{
+   if(n) out.put((const char*)w, n*sizeof(unsigned));
+}
+
+static inline void
+putWords(OutBuf& out, const IdList& l)
+{
+   if(!l.empty()) putWords(out, &l[0], l.size());
+}
+
+static inline size_t
+fedWords(size_t nGates)
+{
+   return (nGates + 31)/32;
+}
+
+// the sections of an image
+struct SnapImage
+{
+   size_t            nGates;
+   const unsigned*   gateWords;
+   const unsigned*   values;
+   const unsigned*   fed;
+   const unsigned*   fanins;
+   const unsigned*   fanoutOfs;
+   const unsigned*   fanouts;
+   const unsigned*   floating;
+   const unsigned*   unUsed;
+   const unsigned*   dfs;
+   const unsigned*   symbols;
+   const char*       names;
+   const unsigned*   fecOfs;
+   const unsigned*   fecMembers;
+};
+
+// offsets[0..n] of a CSR with "total" members
+static bool
+checkOffsets(const unsigned* offsets, size_t n, size_t total)
+{
+   if(offsets[0] != 0 || offsets[n] != total) return false;
+   for(size_t i=0; i<n; i++)
+      if(offsets[i] > offsets[i+1]) return false;
+   return true;
+}
+
+static bool
+checkIds(const unsigned* ids, size_t n, const MarkSet& exists)
+{
+   for(size_t i=0; i<n; i++)
+      if(!exists.isMarked(ids[i])) return false;
+   return true;
+}
+
+// Locate the sections of the image w[0..nWords) and check them;
+// return 0 if it is fine, else what is wrong with it.
+// The header has been checked up to SNAP_WORDS.
+static const char*
+checkSnapshot(const unsigned* w, size_t nWords, SnapImage& img)
+{
+   size_t M = w[SNAP_M], I = w[SNAP_I], L = w[SNAP_L];
+   size_t O = w[SNAP_O], A = w[SNAP_A];
+   size_t nGates = img.nGates = 1 + I + L + O + A;
+   // (64-bit) sums of 32-bit counts do not overflow
+   size_t words = SNAP_HEADER + nGates*2 + nGates + fedWords(nGates)
+                + L + O + A*2 + nGates + 1 + w[SNAP_FANOUTS]
+                + w[SNAP_FLOATING] + w[SNAP_UNUSED] + w[SNAP_DFS]
+                + (size_t)w[SNAP_SYMBOLS]*2 + w[SNAP_SYMBOL_WORDS]
+                + (size_t)w[SNAP_FECS] + 1 + w[SNAP_FEC_MEMBERS];
+   if(words != nWords) return "section sizes do not match the file size";
+   if(I + L + A > M || M + O + 1 > UINT_MAX) return "bad gate counts";
+
+   img.gateWords = w + SNAP_HEADER;
+   img.values = img.gateWords + nGates*2;
+   img.fed = img.values + nGates;
+   img.fanins = img.fed + fedWords(nGates);
+   img.fanoutOfs = img.fanins + L + O + A*2;
+   img.fanouts = img.fanoutOfs + nGates + 1;
+   img.floating = img.fanouts + w[SNAP_FANOUTS];
+   img.unUsed = img.floating + w[SNAP_FLOATING];
+   img.dfs = img.unUsed + w[SNAP_UNUSED];
+   img.symbols = img.dfs + w[SNAP_DFS];
+   img.names = (const char*)(img.symbols + (size_t)w[SNAP_SYMBOLS]*2);
+   img.fecOfs = img.symbols + (size_t)w[SNAP_SYMBOLS]*2 + w[SNAP_SYMBOL_WORDS];
+   img.fecMembers = img.fecOfs + w[SNAP_FECS] + 1;
+
+   // CONST, then PIs, latches and AIGs in 1..M and POs in M+1..M+O
+   MarkSet exists(M+O+1);
+   if(img.gateWords[0] != 0) return "bad CONST gate";
+   exists.mark(0);
+   for(size_t i=1; i<nGates; i++) {
+      size_t id = img.gateWords[i*2];
+      bool isPO = (i > I + L && i <= I + L + O);
+      if(isPO? (id <= M || id > M + O): (id == 0 || id > M))
+         return "gate ID out of range";
+      if(!exists.markNew(id)) return "repeated gate ID";
+   }
+   for(size_t k=0, n=L+O+A*2; k<n; k++)
+      if(img.fanins[k]/2 > M) return "fanin out of range";
+   if(!checkOffsets(img.fanoutOfs, nGates, w[SNAP_FANOUTS]))
+      return "bad fanout offsets";
+   for(size_t j=0; j<w[SNAP_FANOUTS]; j++)
+      if(!exists.isMarked(img.fanouts[j]/2)) return "fanout out of range";
+   if(!checkIds(img.floating, w[SNAP_FLOATING], exists) ||
+      !checkIds(img.unUsed, w[SNAP_UNUSED], exists) ||
+      !checkIds(img.dfs, w[SNAP_DFS], exists))
+      return "list member out of range";
+   size_t nameBytes = (size_t)w[SNAP_SYMBOL_WORDS]*sizeof(unsigned);
+   for(size_t i=0; i<w[SNAP_SYMBOLS]; i++) {
+      size_t off = img.symbols[i*2+1];
+      if(!exists.isMarked(img.symbols[i*2]) || off >= nameBytes ||
+         !memchr(img.names + off, '\0', nameBytes - off))
+         return "bad symbol";
+   }
+   if(!checkOffsets(img.fecOfs, w[SNAP_FECS], w[SNAP_FEC_MEMBERS]))
+      return "bad FEC group offsets";
+   if(!checkIds(img.fecMembers, w[SNAP_FEC_MEMBERS], exists))
+      return "FEC group member out of range";
+   return 0;
+}
+
+/****************************************************/
+/*   Public member functions about netlist images   */
+/****************************************************/
+bool
+CirMgr::saveSnapshot(const string& fileName, unsigned state) const
+{
+   ofstream outfile(fileName.c_str(), ios::out | ios::binary);
+   if(!outfile) {
+      cerr << "Failed to open file " << fileName << endl;
+      return false;
+   }
+   // gates in image order
+   vector<CirGate*> gates;
+   gates.reserve(1 + _PIList.size() + _LatchList.size() + _POList.size() + _AigList.size());
+   gates.push_back(getGate(0));
+   for(size_t i=0; i<_PIList.size(); i++) gates.push_back(getGate(_PIList[i]));
+   for(size_t i=0; i<_LatchList.size(); i++) gates.push_back(getGate(_LatchList[i]));
+   for(size_t i=0; i<_POList.size(); i++) gates.push_back(getGate(_POList[i]));
+   for(size_t i=0; i<_AigList.size(); i++) gates.push_back(getGate(_AigList[i]));
+
+   IdList gateWords, values, fed(fedWords(gates.size()), 0), fanins;
+   IdList fanoutOfs, fanouts;
+   gateWords.reserve(gates.size()*2);
+   values.reserve(gates.size());
+   fanoutOfs.reserve(gates.size()+1);
+   for(size_t i=0; i<gates.size(); i++) {
+      CirGate* temp = gates[i];
+      gateWords.push_back(temp->_gateID);
+      gateWords.push_back(temp->_lineNo);
+      // a gate out of _simFed may never have been simulated
+      if(_simFed.isMarked(temp->_gateID)) {
+         values.push_back(temp->_value);
+         fed[i/32] |= 1u << (i%32);
+      }
+      else values.push_back(0);
+      for(size_t j=0; j<temp->_fanin.size(); j++)
+         fanins.push_back(temp->_fanin[j].literal());
+      fanoutOfs.push_back(fanouts.size());
+      for(size_t j=0; j<temp->_foNum; j++)
+         fanouts.push_back(temp->_foList[j].literal());
+   }
+   fanoutOfs.push_back(fanouts.size());
+
+   IdList symbols;
+   string names;
+   for(size_t i=0; i<_symbolList.size(); i++) {
+      StrRef symbol = _symbolList[_symbolList.id(i)];
+      symbols.push_back(_symbolList.id(i));
+      symbols.push_back(names.size());
+      names.append(symbol.data(), symbol.size()).append(1, '\0');
+   }
+   names.resize((names.size() + sizeof(unsigned)-1)/sizeof(unsigned)*sizeof(unsigned), '\0');
+
+   IdList fecOfs, fecMembers;
+   for(size_t i=0; i<_FECList->size(); i++) {
+      fecOfs.push_back(fecMembers.size());
+      FECGrp* grp = (*_FECList)[i];
+      for(size_t j=0; j<grp->size(); j++)
+         fecMembers.push_back((*grp)[j]->_gateID);
+   }
+   fecOfs.push_back(fecMembers.size());
+
+   unsigned header[SNAP_HEADER];
+   header[SNAP_MAGIC] = SNAP_MAGIC_NUM;
+   header[SNAP_VER] = SNAP_VERSION;
+   header[SNAP_STATE] = state;
+   header[SNAP_M] = _M;   header[SNAP_I] = _I;   header[SNAP_L] = _L;
+   header[SNAP_O] = _O;   header[SNAP_A] = _AigList.size();
+   header[SNAP_FEC_READY] = _FECReady;
+   header[SNAP_FANOUTS] = fanouts.size();
+   header[SNAP_FLOATING] = _floatingList.size();
+   header[SNAP_UNUSED] = _unUsedList.size();
+   header[SNAP_DFS] = _dfsList.size();
+   header[SNAP_SYMBOLS] = _symbolList.size();
+   header[SNAP_SYMBOL_WORDS] = names.size()/sizeof(unsigned);
+   header[SNAP_FECS] = _FECList->size();
+   header[SNAP_FEC_MEMBERS] = fecMembers.size();
+   header[SNAP_WORDS] = SNAP_HEADER + gateWords.size() + values.size()
+                      + fed.size() + fanins.size()
+                      + fanoutOfs.size() + fanouts.size()
+                      + _floatingList.size() + _unUsedList.size()
+                      + _dfsList.size() + symbols.size()
+                      + names.size()/sizeof(unsigned)
+                      + fecOfs.size() + fecMembers.size();
+
+   OutBuf out(outfile);
+   putWords(out, header, SNAP_HEADER);
+   putWords(out, gateWords);
+   putWords(out, values);
+   putWords(out, fed);
+   putWords(out, fanins);
+   putWords(out, fanoutOfs);
+   putWords(out, fanouts);
+   putWords(out, _floatingList);
+   putWords(out, _unUsedList);
+   putWords(out, _dfsList);
+   putWords(out, symbols);
+   out.put(names);
+   putWords(out, fecOfs);
+   putWords(out, fecMembers);
+   return true;
+}
+
+
+// The image is checked, then copied into the lists and the fanout CSR;
+// only the gate objects themselves have to be built.
+bool
+CirMgr::loadSnapshot(const string& fileName, unsigned& state)
+{
+   InFile input;
+   if(!input.open(fileName)) {
+      cerr << "Failed to open file " << fileName << endl;
+      return false;
+   }
+   const unsigned* w = (const unsigned*)input.begin();
+   size_t nWords = input.size()/sizeof(unsigned);
+   if(nWords < SNAP_HEADER || w[SNAP_MAGIC] != SNAP_MAGIC_NUM) {
+      cerr << "Error: \"" << fileName << "\" is not a netlist snapshot!!" << endl;
+      return false;
+   }
+   if(w[SNAP_VER] != SNAP_VERSION) {
+      cerr << "Error: snapshot version " << w[SNAP_VER] << " is not supported "
+           << "(expecting " << SNAP_VERSION << ")!!" << endl;
+      return false;
+   }
+   if(w[SNAP_WORDS] != nWords || input.size() % sizeof(unsigned)) {
+      cerr << "Error: snapshot \"" << fileName << "\" is truncated!!" << endl;
+      return false;
+   }
+   SnapImage img;
+   if(const char* err = checkSnapshot(w, nWords, img)) {
+      cerr << "Error: snapshot \"" << fileName << "\" is corrupted ("
+           << err << ")!!" << endl;
+      return false;
+   }
+   state = w[SNAP_STATE];
+   _M = w[SNAP_M];   _I = w[SNAP_I];   _L = w[SNAP_L];
+   _O = w[SNAP_O];   _A = w[SNAP_A];
+   _FECReady = w[SNAP_FEC_READY];
+   size_t nGates = img.nGates;
+   const unsigned* gateWords = img.gateWords;
+   const unsigned* fanins = img.fanins;
+
+   // gates; fanins are kept as literals until all gates exist
+   _gateList.assign(_M+_O+1, 0);
+   _FECList = new vector<FECGrp*>;
+   _PIList.resize(_I);   _LatchList.resize(_L);
+   _POList.resize(_O);   _AigList.resize(_A);
+   vector<CirGate*> gates(nGates);
+   gates[0] = new(allocGate()) ConstGate;
+   _gateList[0] = gates[0];
+   for(size_t i=1, k=0; i<nGates; i++) {
+      unsigned id = gateWords[i*2], line = gateWords[i*2+1];
+      if(i <= _I) {
+         gates[i] = new(allocGate()) PIGate(id, line);
+         _PIList[i-1] = id;
+      }
+      else if(i <= _I + _L) {
+         gates[i] = new(allocGate()) LatchGate(id, line, fanins[k++]);
+         _LatchList[i-1-_I] = id;
+      }
+      else if(i <= _I + _L + _O) {
+         gates[i] = new(allocGate()) POGate(id, line, fanins[k++]);
+         _POList[i-1-_I-_L] = id;
+      }
+      else {
+         // keep the fanin order as saved; the constructor would sort it
+         gates[i] = new(allocGate()) AigGate(id, line, fanins[k], fanins[k+1]);
+         gates[i]->_fanin[0] = CirGate::CirGateSP(fanins[k]);
+         gates[i]->_fanin[1] = CirGate::CirGateSP(fanins[k+1]);
+         k += 2;
+         _AigList[i-1-_I-_L-_O] = id;
+      }
+      _gateList[id] = gates[i];
+   }
+   // link fanins and take the fanouts from the CSR as they are
+   // simulation values are valid until the next simulation
+   _simFed.clear();
+   _fanouts = new CirFanouts;
+   vector<CirGate::CirGateSP>& list = _fanouts->_list;
+   list.reserve(w[SNAP_FANOUTS]);
+   for(unsigned j=0; j<w[SNAP_FANOUTS]; j++)
+      list.push_back(CirGate::CirGateSP(getGate(img.fanouts[j]/2), img.fanouts[j]%2));
+   for(size_t i=0; i<nGates; i++) {
+      CirGate* temp = gates[i];
+      if(img.fed[i/32] >> (i%32) & 1)
+         temp->feedInput(img.values[i], _simFed);
+      for(size_t j=0; j<temp->_fanin.size(); j++) {
+         unsigned lit = temp->_fanin[j].literal();
+         CirGate* fanin = getGate(lit/2);
+         if(fanin) temp->_fanin[j] = CirGate::CirGateSP(fanin, lit%2);
+      }
+      temp->_foList = (list.empty()? 0: &list[0] + img.fanoutOfs[i]);
+      temp->_foNum = img.fanoutOfs[i+1] - img.fanoutOfs[i];
+   }
+   _floatingList.assign(img.floating, img.floating + w[SNAP_FLOATING]);
+   _unUsedList.assign(img.unUsed, img.unUsed + w[SNAP_UNUSED]);
+   _dfsList.assign(img.dfs, img.dfs + w[SNAP_DFS]);
+   setLevelList();
+   _symbolList.reserve(_gateList.size(), w[SNAP_SYMBOL_WORDS]*sizeof(unsigned));
+   for(size_t i=0; i<w[SNAP_SYMBOLS]; i++) {
+      const char* name = img.names + img.symbols[i*2+1];
+      _symbolList.insert(img.symbols[i*2], StrRef(name, strlen(name)));
+   }
+   for(size_t i=0; i<w[SNAP_FECS]; i++) {
+      FECGrp* grp = new FECGrp;
+      grp->reserve(img.fecOfs[i+1] - img.fecOfs[i]);
+      for(unsigned j=img.fecOfs[i]; j<img.fecOfs[i+1]; j++)
+         grp->push_back(getGate(img.fecMembers[j]));
+      _FECList->push_back(grp);
+   }
+   return true;
+}
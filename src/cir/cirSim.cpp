@@ -12,10 +12,14 @@
 #include <algorithm>
 #include <cassert>
 #include <string>
+#include <cstring>
 #include <sstream>
 #include "cirMgr.h"
 #include "cirGate.h"
+#include "cirAig.h"
 #include "util.h"
+#include "myInFile.h"
+#include "myOutBuf.h"
 
 using namespace std;
 
@@ -30,6 +34,27 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// transpose n words, 32 at a time, into rows
+// bit j of rows[k*nBlk + b] = bit k of words[b*32 + j]
+static void
+transposeBits(const unsigned* words, size_t n, unsigned* rows, size_t nBlk)
+{
+   const unsigned W = sizeof(unsigned)*8;
+   unsigned blk[sizeof(unsigned)*8];
+   for(size_t b=0; b<nBlk; b++) {
+      for(unsigned j=0; j<W; j++) blk[j] = (b*W + j < n)? words[b*W + j]: 0;
+      // swap off-diagonal sub-blocks of width 16, 8, ..., 1
+      unsigned m = 0x0000ffff;
+      for(unsigned w=W/2; w; w >>= 1, m ^= (m << w)) {
+         for(unsigned j=0; j<W; j = (j + w + 1) & ~w) {
+            unsigned t = ((blk[j] >> w) ^ blk[j + w]) & m;
+            blk[j] ^= (t << w);
+            blk[j + w] ^= t;
+         }
+      }
+      for(unsigned k=0; k<W; k++) rows[k*nBlk + b] = blk[k];
+   }
+}
 
 /************************************************/
 /*   Public member functions about Simulation   */
@@ -38,11 +63,15 @@ using namespace std;
 void
 CirMgr::randomSim()
 {
-   unsigned * inputs = new unsigned[_I];
+   // latches are free inputs here, like PIs
+   unsigned * inputs = new unsigned[_I+_L];
    unsigned count = 0, fail = 0;
+   CirAig aig;
+   buildAig(aig);
+   vector<unsigned> value(aig.size(), 0);
    while(!_FECReady || fail < 30) {
-      for(size_t i=0; i<_I; i++) inputs[i] = rnGen(INT_MAX);
-      if(simulate(inputs))   fail = 0;
+      for(size_t i=0; i<_I+_L; i++) inputs[i] = rnGen(INT_MAX);
+      if(simulate(aig, value, inputs))   fail = 0;
       else fail++;
       writeSimLog(inputs);
       count++;
@@ -51,67 +80,136 @@ CirMgr::randomSim()
         << count*sizeof(unsigned)*8 << " patterns simulated.";
 }
 
+// one pattern per line; the file may be mapped or decompressed
 void
-CirMgr::fileSim(ifstream& patternFile)
+CirMgr::fileSim(InFile& patternFile)
 {
-   unsigned* inputs = new unsigned[_I];
-   char* buffer = new char[_I];
-   for(size_t i=0; i<_I; i++) inputs[i] = 0;
-	string str;
-	stringstream ss(str);
+   // latches stay in their initial state (0)
+   unsigned* inputs = new unsigned[_I+_L];
+   for(size_t i=0; i<_I+_L; i++) inputs[i] = 0;
+   CirAig aig;
+   buildAig(aig);
+   vector<unsigned> value(aig.size(), 0);
+   const char* p = patternFile.begin();
+   const char* end = patternFile.end();
    unsigned line = 0, digit = 0;
    bool done = false, get;
 	while(!done) {
-      if(!getline(patternFile,str)) done = true;
+      patternFile.refill(p, end);
+      if(p == end) done = true;
       else {
+         const char* str = p;
+         const char* eol = (const char*)memchr(p, '\n', end - p);
+         if(!eol) eol = end;
+         p = (eol < end)? eol + 1: end;
          get = true;
-         if(str.length() != _I) {
-            cout << "Error: Pattern(" << str << ") legnth(" << str.length() << ") "
+         if((size_t)(eol - str) != _I) {
+            cout << "Error: Pattern(" << string(str, eol) << ") legnth(" << eol - str << ") "
                  << "does not match the number of inputs(" << _I << ") in the circuit!!" << endl;
             get = false;
          }
          else 
             for(size_t i=0; i<_I; i++)
                if(str[i] != '0' && str[i] != '1') {
-                  cout << "Error: Pattern(" << str << ") contains non-0/1 character('"
+                  cout << "Error: Pattern(" << string(str, eol) << ") contains non-0/1 character('"
                        << str[i] << "')." << endl;
                   get = false;
                }
          if(get) {
             line++;
-            ss.str(""); ss.clear();
-            ss << str;
-            for(size_t i=0; i<_I; i++) {
-               ss >> buffer[i];
-               inputs[i] += ((unsigned)buffer[i]-48) << digit;
-            }
+            for(size_t i=0; i<_I; i++)
+               inputs[i] += ((unsigned)str[i]-48) << digit;
             digit++;
          }
       }
       if(digit >= (sizeof(unsigned)*8) || done) {
-         simulate(inputs);
+         simulate(aig, value, inputs);
          writeSimLog(inputs, digit);
          for(size_t i=0; i<_I; i++) inputs[i] = 0;
          digit = 0;
       }
    }
    cout << line << " patterns simulated." << endl;
-   delete inputs;
-   delete buffer;
+   delete [] inputs;
+}
+
+// 64 traces of a sequential simulation, one per bit
+typedef unsigned long long SeqWord;
+
+static inline SeqWord
+randomWord()
+{
+   return ((SeqWord)rnGen(INT_MAX) << 33) ^ ((SeqWord)rnGen(INT_MAX) << 2) ^ rnGen(4);
+}
+
+// Each cycle applies random PI values to 64 traces at once. The latches
+// start from 0, and their states are kept in a flat array between
+// cycles. The Aig gates are evaluated on the flat AIG. Both 32-trace
+// halves of each cycle are then fed to the gates to divide the FEC
+// groups, as a combinational simulation does.
+void
+CirMgr::seqSim(unsigned cycles)
+{
+   const unsigned W = sizeof(unsigned)*8;
+   CirAig aig;
+   buildAig(aig);
+   vector<SeqWord> value(aig.size(), 0), state(_L, 0);
+   vector<unsigned> inputs(_I + _L + 1);
+   for(unsigned c=0; c<cycles; c++) {
+      for(size_t i=0; i<_I; i++) value[1+i] = randomWord();
+      for(size_t k=0; k<_L; k++) value[1+_I+k] = state[k];
+      aig.simulate(&value[0]);
+      for(size_t k=0; k<_L; k++)
+         state[k] = aig.literalValue(&value[0], aig.next(k));
+
+      for(unsigned h=0; h<2; h++) {
+         _simFed.clear();
+         for(size_t i=0; i<_I+_L; i++) {
+            inputs[i] = (unsigned)(value[1+i] >> (W*h));
+            getGate(aig.gateID(1+i))->feedInput(inputs[i], _simFed);
+         }
+         for(size_t i=aig.firstAnd(); i<aig.size(); i++)
+            getGate(aig.gateID(i))->feedInput((unsigned)(value[i] >> (W*h)), _simFed);
+         divideFEC();
+         writeSimLog(&inputs[0]);
+      }
+   }
+   cout << cycles << " cycles of " << 2*W << " traces simulated." << endl;
 }
 
+// inputs: one word for each PI, then one for each latch
 bool
 CirMgr::simulate(unsigned* inputs)
 {
-   CirGate::_markFlagRef++;
+   _simFed.clear();
    CirGate* temp;
    for(size_t i=0; i<_I; i++) {
       temp = getGate(_PIList[i]);
-      temp->feedInput(inputs[i]);
+      temp->feedInput(inputs[i], _simFed);
   }
+   for(size_t i=0; i<_L; i++) {
+      temp = getGate(_LatchList[i]);
+      temp->feedInput(inputs[_I+i], _simFed);
+   }
   return divideFEC();
 }
 
+// the same on the flat AIG of the netlist, whose gates all get their
+// values at once; "value" is the work array of its nodes
+bool
+CirMgr::simulate(const CirAig& aig, vector<unsigned>& value, unsigned* inputs)
+{
+   _simFed.clear();
+   for(size_t i=1; i<aig.firstAnd(); i++) value[i] = inputs[i-1];
+   aig.simulate(&value[0]);
+   // every gate of aig takes its value back and is marked as fed
+   for(size_t i=1; i<aig.size(); i++) {
+      getGate(aig.gateID(i))->_value = value[i];
+      _simFed.mark(aig.gateID(i));
+   }
+   return divideFEC();
+}
+
 void
 CirMgr::initFEC()
 {
@@ -140,29 +238,32 @@ CirMgr::divideFEC()
       size_t number = oriGrp->size();
 
       // check if the group can be divided
-      simVal = (*oriGrp)[0]->getSimValue();
+      simVal = (*oriGrp)[0]->getSimValue(_simFed);
       divided = false;
       for(size_t j = 1; j<number; j++)
-         if((*oriGrp)[j]->getSimValue() != simVal &&
-            (*oriGrp)[j]->getSimValue() != ~simVal   ) { divided = true; break; }
+         if((*oriGrp)[j]->getSimValue(_simFed) != simVal &&
+            (*oriGrp)[j]->getSimValue(_simFed) != ~simVal   ) { divided = true; break; }
       if(grpInc > 0) grpInc++; // so it will only equals to 1 for one time
       if(divided) {
          grpInc++;
-         HashMap<ID, FECGrp*> newGrps(getHashSize(number));
+         // the new groups are kept in the order they first appear
+         FlatHashMap<ID, FECGrp*> newGrps(number);
+         vector<FECGrp*> grps;
          for(size_t j = 0; j<number; j++) {
-            simVal = (*oriGrp)[j]->getSimValue();
+            simVal = (*oriGrp)[j]->getSimValue(_simFed);
             if(newGrps.query(simVal, newGrp) || 
                newGrps.query(~simVal, newGrp)  ) newGrp->push_back((*oriGrp)[j]);
             else {
                newGrp = new FECGrp;
                newGrp->push_back((*oriGrp)[j]);
                newGrps.insert(simVal, newGrp);
+               grps.push_back(newGrp);
             }
          }
-         for(HashMap<ID, FECGrp*>::iterator it = newGrps.begin(); it != newGrps.end(); it++) {
-            if((*it).second->size() > 3) _FECReady = false;
-            if((*it).second->size() > 1) newFECList->push_back((*it).second);
-            else delete (*it).second;
+         for(size_t k = 0; k<grps.size(); k++) {
+            if(grps[k]->size() > 3) _FECReady = false;
+            if(grps[k]->size() > 1) newFECList->push_back(grps[k]);
+            else delete grps[k];
          }
          delete oriGrp;
       }
@@ -182,55 +283,71 @@ CirMgr::divideFEC()
    return (grpInc > 0);
 }
 
+// each row is one pattern: the input bits, a space, the output bits
+// rows are taken from the words 32 columns at a time by transposing
+// 32x32 bit blocks, so every column is written from a whole word
 bool
 CirMgr::writeSimLog(unsigned* inputs, unsigned n)
 {
    if(!_simLog)   return false;
-   unsigned* outputs = new unsigned[_O];
-   for(size_t i=0; i<_O; i++) outputs[i] = getGate(_POList[i])->getSimValue();
-   for(size_t i=0; i<n; i++) {
-      for(size_t j=0; j<_I; j++) {
-         (*_simLog) << (inputs[j] & 1);
-         inputs[j] = inputs[j] >> 1;
-      }
-      (*_simLog) << ' ';
-      for(size_t j=0; j<_O; j++) {
-         (*_simLog) << (outputs[j] & 1);
-         outputs[j] = outputs[j] >> 1;
-      }
-      (*_simLog) << '\n';
+   const unsigned W = sizeof(unsigned)*8;
+   vector<unsigned> outputs(_O);
+   for(size_t i=0; i<_O; i++) outputs[i] = getGate(_POList[i])->getSimValue(_simFed);
+   // rows[k*nBlk + b] holds bit k of the 32 words in block b
+   size_t inBlk = (_I + W-1)/W, outBlk = (_O + W-1)/W;
+   vector<unsigned> inRows(W*inBlk), outRows(W*outBlk);
+   if(_I) transposeBits(inputs, _I, &inRows[0], inBlk);
+   if(_O) transposeBits(&outputs[0], _O, &outRows[0], outBlk);
+   for(size_t k=0; k<n; k++) {
+      for(size_t b=0; b<inBlk; b++)
+         _simLog->putBits(inRows[k*inBlk + b], (b+1 < inBlk)? W: _I - b*W);
+      _simLog->put(' ');
+      for(size_t b=0; b<outBlk; b++)
+         _simLog->putBits(outRows[k*outBlk + b], (b+1 < outBlk)? W: _O - b*W);
+      _simLog->put('\n');
    }
    return true;
 }
 
+void
+CirMgr::setSimLog(ofstream *logFile)
+{
+   if(_simLog) delete _simLog;   // writes out what is left
+   _simLog = (logFile? new OutBuf(*logFile): 0);
+}
+
+// the value of a gate not fed yet, from its fanins
 unsigned
-CirGate::getSimValue()
+CirGate::evalSimValue(MarkSet& fed)
 {
-   if(_markFlag == _markFlagRef) {
-   	return _value;
-   }
-   if(getTypeStr() == "CONST")  {}
-   // for PO
-   else if(!isAig()) {
-   	_value = _fanin[0].gate()->getSimValue();
-   	if(_fanin[0].isInv())	_value = ~_value;
-   }
-   // for Aig
-   else {
+   switch(_type) {
+   case PO_GATE:
+      if(_fanin[0].isFlt())   _value = 0;
+      else {
+         _value = _fanin[0].gate()->getSimValue(fed);
+         if(_fanin[0].isInv())   _value = ~_value;
+      }
+      break;
+   case AIG_GATE: {
       unsigned input1, input2;
       if(_fanin[0].isFlt())   input1 = 0;
       else {
-         input1 = _fanin[0].gate()->getSimValue();
+         input1 = _fanin[0].gate()->getSimValue(fed);
          if(_fanin[0].isInv())   input1 = ~input1;
       }
       if(_fanin[1].isFlt())   input2 = 0;
       else {
-         input2 = _fanin[1].gate()->getSimValue();
+         input2 = _fanin[1].gate()->getSimValue(fed);
          if(_fanin[1].isInv())   input2 = ~input2;
       }
       _value = input1 & input2;
+      break;
+   }
+   // a PI, CONST or latch holds its value until it is fed
+   default:
+      break;
    }
-    _markFlag = _markFlagRef;
+   fed.mark(_gateID);
    return _value;
 }
 
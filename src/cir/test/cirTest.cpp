@@ -0,0 +1,483 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include "cirMgr.h"
+#include "myInFile.h"
+
+using namespace std;
+
+// cirTest <test> <file>...
+//
+// roundtrip <circuit>...
+//    Writes each circuit with -Binary (writeAig), reads it back and
+//    checks that the two simulate the same on all the input patterns (up
+//    to 2^12), and that writing the circuit read back keeps the number of
+//    gates.
+//    reconv.aag: gate 6 is a fanin of both gates 8 and 10, so it is
+//    reached twice on the way from the PO; it must be written only once.
+//    reconvseq.aag: the same with a latch, whose next state shares gate 8
+//    with the PO.
+//
+// miter <golden> <revised>...
+//    Builds the miter of each pair, which must be equivalent, and checks
+//    that its POs are all constant 0 once it is built.
+//    floatg.aag/floatr.aag: a floating fanin is 0 even if inverted, so an
+//    AND with !floating and the PO !floating are both 0.
+//
+// snapshot <circuit>...
+//    Simulates each circuit, saves a snapshot of it (CIRSAve) and loads
+//    it back (CIRLoad) into a new CirMgr, which must print the same
+//    netlist and AAG, and save the same snapshot again (so the values,
+//    FEC groups and lists are the same as well). Then damaged copies of the snapshot (bad
+//    magic, another version, truncated, a fanin out of range) must not
+//    load.
+//
+// fraig <circuit> <patterns>...
+//    Runs fileSim() of the patterns and fraig twice on each circuit, with
+//    the proof cache and without it; the cached run must hit in the second
+//    round and give the same merges, FEC groups (a snapshot of the second
+//    fileSim()) and circuit.
+//    fraig.aag/fraig.pat: the patterns are few, so that many pairs are
+//    proved SAT, more than 20 in the first round (their counterexamples
+//    are simulated); some are equivalent, and some inverted.
+//
+// parse
+//    Reads each of the ill-formed files of badFiles[] and checks that
+//    readCircuit() fails with the message of its error.
+//
+
+static string
+readFile(const string& name)
+{
+   ifstream f(name.c_str(), ios::binary);
+   stringstream s;
+   s << f.rdbuf();
+   return s.str();
+}
+
+// header "aag M I L O A" or "aig M I L O A"; returns false if ill-formed
+static bool
+readHeader(const string& name, unsigned h[5])
+{
+   ifstream f(name.c_str(), ios::binary);
+   string tag;
+   f >> tag >> h[0] >> h[1] >> h[2] >> h[3] >> h[4];
+   return (f && (tag == "aag" || tag == "aig"));
+}
+
+// all the patterns of the first 12 of "inputs", the others at 0
+static void
+writePatterns(unsigned inputs, const string& name)
+{
+   ofstream o(name.c_str());
+   unsigned n = (inputs < 12? inputs: 12);
+   for(unsigned p=0; p < (1u << n); p++) {
+      for(unsigned i=0; i<inputs; i++)
+         o << ((i < n && (p >> i & 1))? '1': '0');
+      o << '\n';
+   }
+}
+
+static bool
+simulate(const string& circuit, const string& patterns, const string& log)
+{
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->readCircuit(circuit);
+   if(ok) {
+      InFile f;
+      ofstream o(log.c_str());
+      ok = f.open(patterns);
+      if(ok) {
+         cirMgr->setSimLog(&o);
+         cirMgr->fileSim(f);
+         cirMgr->setSimLog(0);
+      }
+   }
+   delete cirMgr;   cirMgr = 0;
+   return ok;
+}
+
+static bool
+writeBinary(const string& circuit, const string& out)
+{
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->readCircuit(circuit);
+   if(ok) {
+      ofstream o(out.c_str(), ios::binary);
+      cirMgr->writeAig(o);
+   }
+   delete cirMgr;   cirMgr = 0;
+   return ok;
+}
+
+static bool
+testRoundTrip(const string& circuit)
+{
+   unsigned h[5], hb[5];
+   if(!readHeader(circuit, h)) {
+      cerr << circuit << ": cannot read the header!!" << endl;
+      return false;
+   }
+   const string patterns = "pattern.tmp";
+   writePatterns(h[1], patterns);
+   const string aig = "roundtrip.tmp", aig2 = "roundtrip2.tmp";
+   const string log = "sim.tmp", log2 = "sim2.tmp";
+   if(!writeBinary(circuit, aig) || !readHeader(aig, hb)) {
+      cerr << circuit << ": -Binary output cannot be written!!" << endl;
+      return false;
+   }
+   if(hb[0] != hb[1] + hb[2] + hb[4] || hb[4] > h[4]) {
+      cerr << circuit << ": bad -Binary header (aig " << hb[0] << " "
+           << hb[1] << " " << hb[2] << " " << hb[3] << " " << hb[4] << ")!!"
+           << endl;
+      return false;
+   }
+   if(!simulate(circuit, patterns, log) || !simulate(aig, patterns, log2)) {
+      cerr << circuit << ": -Binary output cannot be read back!!" << endl;
+      return false;
+   }
+   if(readFile(log) != readFile(log2)) {
+      cerr << circuit << ": -Binary output simulates differently!!" << endl;
+      return false;
+   }
+   // the gates are renumbered, but none is added or lost
+   unsigned hb2[5];
+   if(!writeBinary(aig, aig2) || !readHeader(aig2, hb2) ||
+      hb2[0] != hb[0] || hb2[4] != hb[4]) {
+      cerr << circuit << ": -Binary output changes when written again!!" << endl;
+      return false;
+   }
+   return true;
+}
+
+// what cirMgr prints of its netlist and AAG
+static string
+dumpCircuit()
+{
+   stringstream s;
+   streambuf* old = cout.rdbuf(s.rdbuf());
+   cirMgr->printSummary();
+   cirMgr->printNetlist();
+   cirMgr->printPIs();
+   cirMgr->printPOs();
+   cirMgr->printFloatGates();
+   cirMgr->writeAag(cout);
+   cout.rdbuf(old);
+   return s.str();
+}
+
+// loads "snap" into a new cirMgr; "error" gets the first line on cerr
+static bool
+loadSnapshot(const string& snap, unsigned& state, string& error)
+{
+   stringstream err;
+   streambuf* old = cerr.rdbuf(err.rdbuf());
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->loadSnapshot(snap, state);
+   cerr.rdbuf(old);
+   getline(err, error);
+   return ok;
+}
+
+// "words" with word i set to "value" (or cut there if "cut"), as "name"
+static void
+writeDamaged(const string& words, size_t i, unsigned value, bool cut,
+             const string& name)
+{
+   string w = words.substr(0, cut? i*4: words.size());
+   if(!cut)   memcpy(&w[i*4], &value, 4);
+   ofstream o(name.c_str(), ios::binary);
+   o << w;
+}
+
+static bool
+testSnapshot(const string& circuit)
+{
+   unsigned h[5];
+   const string patterns = "pattern.tmp", snap = "snap.tmp", snap2 = "snap2.tmp";
+   const string bad = "badsnap.tmp";
+   if(!readHeader(circuit, h)) {
+      cerr << circuit << ": cannot read the header!!" << endl;
+      return false;
+   }
+   writePatterns(h[1], patterns);
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->readCircuit(circuit);
+   string before;
+   if(ok) {
+      InFile f;
+      ok = f.open(patterns);
+      if(ok) {
+         streambuf* old = cout.rdbuf(0);
+         cirMgr->fileSim(f);
+         cout.rdbuf(old);
+         cout.clear();
+         before = dumpCircuit();
+         ok = cirMgr->saveSnapshot(snap, 7);
+      }
+   }
+   delete cirMgr;   cirMgr = 0;
+   if(!ok) {
+      cerr << circuit << ": the snapshot cannot be saved!!" << endl;
+      return false;
+   }
+   unsigned state = 0;
+   string error;
+   ok = loadSnapshot(snap, state, error);
+   string after;
+   if(ok) {
+      after = dumpCircuit();
+      ok = cirMgr->saveSnapshot(snap2, state);
+   }
+   delete cirMgr;   cirMgr = 0;
+   if(!ok || state != 7) {
+      cerr << circuit << ": the snapshot cannot be loaded (" << error << ")!!"
+           << endl;
+      return false;
+   }
+   if(after != before || readFile(snap2) != readFile(snap)) {
+      cerr << circuit << ": the snapshot loads a different circuit!!" << endl;
+      return false;
+   }
+
+   // the header is magic, version, size in words, state, M, I, L, O, A
+   // and 9 more words; the fanins follow the gates (2 words each), the
+   // values (1 word each) and the fed bits
+   string words = readFile(snap);
+   size_t nGates = 1 + h[1] + h[2] + h[3], nWords = words.size()/4;
+   unsigned A;
+   memcpy(&A, &words[8*4], 4);
+   nGates += A;
+   size_t fanins = 18 + nGates*3 + (nGates + 31)/32;
+   struct {
+      size_t      word;
+      unsigned    value;
+      bool        cut;
+      string      error;
+   } damaged[] = {
+      { 0, 0, false, "Error: \"" + bad + "\" is not a netlist snapshot!!" },
+      { 1, 99, false,
+        "Error: snapshot version 99 is not supported (expecting 3)!!" },
+      { nWords - 1, 0, true, "Error: snapshot \"" + bad + "\" is truncated!!" },
+      { fanins, ~0u, false, "Error: snapshot \"" + bad
+        + "\" is corrupted (fanin out of range)!!" }
+   };
+   for(size_t i=0; i<sizeof(damaged)/sizeof(damaged[0]); i++) {
+      writeDamaged(words, damaged[i].word, damaged[i].value, damaged[i].cut, bad);
+      ok = loadSnapshot(bad, state, error);
+      delete cirMgr;   cirMgr = 0;
+      if(ok || error != damaged[i].error) {
+         cerr << circuit << ": damaged snapshot " << i << ": \"" << error
+              << "\" instead of \"" << damaged[i].error << "\"!!" << endl;
+         return false;
+      }
+   }
+   return true;
+}
+
+// the ill-formed files, each with the error message readCircuit() gives
+struct BadFile {
+   const char*    name;
+   const char*    text;
+   const char*    error;
+};
+
+static const BadFile badFiles[] = {
+   { "bad header", "aagx 3 2 0 1 1\n2\n4\n6\n6 2 4\n",
+     "[ERROR] Line 1: Illegal identifier \"aagx\"!!" },
+   { "M too small", "aag 3 2 0 1 2\n2\n4\n6\n6 2 4\n",
+     "[ERROR] Line 1: Number of variables is too small (3)!!" },
+   { "missing A", "aag 3 2 0 1\n2\n4\n6\n6 2 4\n",
+     "[ERROR] Line 1, Col 12: Missing number of AIGs!!" },
+   { "AIG literal above M", "aag 3 2 0 1 1\n2\n4\n6\n6 2 10\n",
+     "[ERROR] Line 5, Col 5: Literal \"10\" exceeds maximum valid ID!!" },
+   { "PO literal above M", "aag 3 2 0 1 1\n2\n4\n8\n6 2 4\n",
+     "[ERROR] Line 4, Col 1: Literal \"8\" exceeds maximum valid ID!!" },
+   { "redefined AIG", "aag 4 2 0 1 2\n2\n4\n6\n6 2 4\n6 4 2\n",
+     "[ERROR] Line 6: Literal \"6\" is redefined, previously defined as "
+     "AIG in line 5!!" },
+   // the first delta of the AND only, then the end of the file
+   { "truncated binary AND", "aig 3 2 0 1 1\n6\n\x02",
+     "[ERROR] Line 5: Missing AIG definition!!" },
+   { "binary AND section missing", "aig 3 2 0 1 1\n6\n",
+     "[ERROR] Line 5: Missing AIG definition!!" },
+   { "symbol index too big", "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\ni2 a\n",
+     "[ERROR] Line 6: PI index is too big (2)!!" },
+   { "bad symbol type", "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\nx0 a\n",
+     "[ERROR] Line 6, Col 1: Illegal symbol type (x)!!" },
+   { "redefined symbol", "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\ni0 a\ni0 b\n",
+     "[ERROR] Line 7: Symbolic name for \"i0\" is redefined!!" },
+   { "missing symbol name", "aag 3 2 0 1 1\n2\n4\n6\n6 2 4\ni0\n",
+     "[ERROR] Line 6: Missing \"symbolic name\"!!" }
+};
+
+static bool
+testBadFile(const BadFile& bad)
+{
+   const string file = "bad.tmp";
+   {
+      ofstream o(file.c_str(), ios::binary);
+      o.write(bad.text, strlen(bad.text));
+   }
+   stringstream err;
+   streambuf* old = cerr.rdbuf(err.rdbuf());
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->readCircuit(file);
+   delete cirMgr;   cirMgr = 0;
+   cerr.rdbuf(old);
+   string line;
+   getline(err, line);
+   if(ok) {
+      cerr << bad.name << ": read without an error!!" << endl;
+      return false;
+   }
+   if(line != bad.error) {
+      cerr << bad.name << ": \"" << line << "\" instead of \"" << bad.error
+           << "\"!!" << endl;
+      return false;
+   }
+   return true;
+}
+
+// reads "circuit" and runs fileSim() of "patterns" and then fraig on it
+// twice, with the proof cache or without; returns the merges, the
+// snapshot "snap" of the second fileSim() (so its FEC groups) and the
+// netlist and AAG, and "hits" gets the hits of the cache
+static string
+fraigTwice(const string& circuit, const string& patterns, bool cache,
+           const string& snap, size_t& hits)
+{
+   stringstream s, merges;
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->readCircuit(circuit);
+   streambuf* old = cout.rdbuf(s.rdbuf());
+   for(int round=0; ok && round<2; round++) {
+      InFile f;
+      ok = f.open(patterns);
+      if(ok) {
+         cirMgr->fileSim(f);
+         if(round == 1)   ok = cirMgr->saveSnapshot(snap, 0);
+         cirMgr->fraig(true, cache);
+      }
+   }
+   cout.rdbuf(old);
+   // only the merges: a SAT verdict from the cache adds no pattern, so
+   // the groups are split by fewer of them on the way
+   hits = 0;
+   for(string line; getline(s, line); ) {
+      if(line.find(" merging ") != string::npos)   merges << line << '\n';
+      else if(line.compare(0, 13, "Proof cache: ") == 0)
+         hits = atoi(line.c_str() + 13);
+   }
+   if(ok)   merges << readFile(snap) << dumpCircuit();
+   delete cirMgr;   cirMgr = 0;
+   return (ok? merges.str(): "");
+}
+
+static bool
+testFraig(const string& circuit, const string& patterns)
+{
+   size_t hits, noHits;
+   string cached = fraigTwice(circuit, patterns, true, "snap.tmp", hits);
+   string uncached = fraigTwice(circuit, patterns, false, "snap.tmp", noHits);
+   if(cached.empty() || uncached.empty()) {
+      cerr << circuit << ": cannot be simulated or fraiged!!" << endl;
+      return false;
+   }
+   if(hits == 0 || noHits != 0) {
+      cerr << circuit << ": " << hits << " hits with the proof cache, "
+           << noHits << " without!!" << endl;
+      return false;
+   }
+   if(cached.find(" merging ") == string::npos) {
+      cerr << circuit << ": nothing is merged!!" << endl;
+      return false;
+   }
+   if(cached != uncached) {
+      cerr << circuit << ": fraig with the proof cache gives other FEC "
+           << "groups or merges!!" << endl;
+      return false;
+   }
+   return true;
+}
+
+static bool
+testMiter(const string& golden, const string& revised)
+{
+   cirMgr = new CirMgr;
+   bool ok = cirMgr->readMiter(golden, revised);
+   stringstream s;
+   if(ok)   cirMgr->writeAag(s);
+   delete cirMgr;   cirMgr = 0;
+   unsigned h[5];
+   string tag;
+   if(!ok || !(s >> tag >> h[0] >> h[1] >> h[2] >> h[3] >> h[4])) {
+      cerr << golden << ", " << revised << ": the miter cannot be built!!"
+           << endl;
+      return false;
+   }
+   unsigned lit;
+   for(unsigned i=0; i<h[1]+h[2]; i++)   s >> lit;
+   for(unsigned i=0; i<h[3]; i++) {
+      if(!(s >> lit) || lit != 0) {
+         cerr << golden << ", " << revised << ": PO " << i
+              << " of the miter is not constant 0!!" << endl;
+         return false;
+      }
+   }
+   return true;
+}
+
+int
+main(int argc, char** argv)
+{
+   string test = (argc > 1? argv[1]: "");
+   int failed = 0;
+   if(test == "roundtrip") {
+      for(int i=2; i<argc; i++) {
+         bool ok = testRoundTrip(argv[i]);
+         cout << (ok? "PASS ": "FAIL ") << argv[i] << endl;
+         if(!ok) failed++;
+      }
+   }
+   else if(test == "miter" && argc % 2 == 0) {
+      for(int i=2; i<argc; i+=2) {
+         bool ok = testMiter(argv[i], argv[i+1]);
+         cout << (ok? "PASS ": "FAIL ") << argv[i] << " " << argv[i+1] << endl;
+         if(!ok) failed++;
+      }
+   }
+   else if(test == "snapshot") {
+      for(int i=2; i<argc; i++) {
+         bool ok = testSnapshot(argv[i]);
+         cout << (ok? "PASS ": "FAIL ") << argv[i] << endl;
+         if(!ok) failed++;
+      }
+   }
+   else if(test == "fraig" && argc % 2 == 0) {
+      for(int i=2; i<argc; i+=2) {
+         bool ok = testFraig(argv[i], argv[i+1]);
+         cout << (ok? "PASS ": "FAIL ") << argv[i] << " " << argv[i+1] << endl;
+         if(!ok) failed++;
+      }
+   }
+   else if(test == "parse" && argc == 2) {
+      for(size_t i=0; i<sizeof(badFiles)/sizeof(badFiles[0]); i++) {
+         bool ok = testBadFile(badFiles[i]);
+         cout << (ok? "PASS ": "FAIL ") << badFiles[i].name << endl;
+         if(!ok) failed++;
+      }
+   }
+   else {
+      cerr << "Usage: cirTest roundtrip <circuit>..." << endl
+           << "       cirTest miter <golden> <revised>..." << endl
+           << "       cirTest snapshot <circuit>..." << endl
+           << "       cirTest fraig <circuit> <patterns>..." << endl
+           << "       cirTest parse" << endl;
+      return 1;
+   }
+   return (failed? 1: 0);
+}
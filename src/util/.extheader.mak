@@ -1,4 +1,4 @@
-util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h ../../include/myHashMap.h 
+util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h ../../include/myHashMap.h ../../include/myHashSet.h ../../include/myInFile.h ../../include/myOutBuf.h ../../include/myThread.h ../../include/myMemPool.h ../../include/myMarkSet.h ../../include/myStrPool.h 
 ../../include/util.h: util.h
 	@rm -f ../../include/util.h
 	@ln -fs ../src/util/util.h ../../include/util.h
@@ -11,3 +11,24 @@ util.d: ../../include/util.h ../../include/rnGen.h ../../include/myUsage.h ../..
 ../../include/myHashMap.h: myHashMap.h
 	@rm -f ../../include/myHashMap.h
 	@ln -fs ../src/util/myHashMap.h ../../include/myHashMap.h
+../../include/myHashSet.h: myHashSet.h
+	@rm -f ../../include/myHashSet.h
+	@ln -fs ../src/util/myHashSet.h ../../include/myHashSet.h
+../../include/myInFile.h: myInFile.h
+	@rm -f ../../include/myInFile.h
+	@ln -fs ../src/util/myInFile.h ../../include/myInFile.h
+../../include/myOutBuf.h: myOutBuf.h
+	@rm -f ../../include/myOutBuf.h
+	@ln -fs ../src/util/myOutBuf.h ../../include/myOutBuf.h
+../../include/myThread.h: myThread.h
+	@rm -f ../../include/myThread.h
+	@ln -fs ../src/util/myThread.h ../../include/myThread.h
+../../include/myMemPool.h: myMemPool.h
+	@rm -f ../../include/myMemPool.h
+	@ln -fs ../src/util/myMemPool.h ../../include/myMemPool.h
+../../include/myMarkSet.h: myMarkSet.h
+	@rm -f ../../include/myMarkSet.h
+	@ln -fs ../src/util/myMarkSet.h ../../include/myMarkSet.h
+../../include/myStrPool.h: myStrPool.h
+	@rm -f ../../include/myStrPool.h
+	@ln -fs ../src/util/myStrPool.h ../../include/myStrPool.h
@@ -42,188 +42,307 @@ public:
    HashMap(size_t b=0) : _numBuckets(0), _buckets(0) { if (b != 0) init(b); }
    ~HashMap() { reset(); }
 
-   // [Optional] TODO: implement the HashMap<HashKey, HashData>::iterator
-   // o An iterator should be able to go through all the valid HashNodes
-   //   in the HashMap
-   // o Functions to be implemented:
-   //   - constructor(s), destructor
-   //   - operator '*': return the HashNode
-   //   - ++/--iterator, iterator++/--
-   //   - operators '=', '==', !="
-   //
+   // The entries are kept back to back in _nodes, and a bucket only
+   // holds their indices; so size(), empty(), begin() and end() take no
+   // scan, and going through the map visits the entries only, not the
+   // buckets. The order is that of insertion, except that remove() moves
+   // the last entry into the place of the removed one.
    class iterator
    {
       friend class HashMap<HashKey, HashData>;
 
    public:
-		iterator(): _map(NULL), _num(0), _node(0) {}
-		iterator(const HashMap* s, size_t b, short n): _map(s), _num(b), _node(n) {}
-		~iterator() {}
-
-		const HashNode& operator*() const { return (*_map)[_num][_node]; }
-		iterator& operator ++ () {			// ++it
-			if(*this != _map->end()) {
-				_node++;
-				size_t _numBkup = _num;
-				if((size_t)_node == (*_map)[_num].size()) {
-					_num++;
-					while(_num < _map->numBuckets()) { 
-						if(!(*_map)[_num].empty()) { _node = 0; return (*this); }
-						_num++;
-					}
-					_num = _numBkup;
-				}
-			}
-			return (*this);
-		}
-		iterator operator ++ (int) {		// it++
-			iterator result = *this;
-			++(*this);
-			return result;
-		}
-		iterator& operator -- () {			// --it
-			if(*this != _map->begin()) {
-				if(_node != 0)	_node--;
-				else 	while(_num >= 0) {
-							_num--;
-							if(!(*_map)[_num].empty()){
-								_node = (*_map)[_num].size()-1;
-								return (*this);
-							}
-						}
-			}
-			return (*this);
-		}
-		iterator operator -- (int) {		// it--
-			iterator result = *this;
-			--(*this);
-			return result;
-		}
-		iterator& operator = (const iterator& it){
-			if(_node != it._node) {
-				_map = it._map;
-				_num = it._num;
-				_node = it._node;
-			}
-		}
-		// bool operator == (const iterator& it) {
-		// 	return (_map == it._map) && (_num == it._num) && (_node == it._node);
-		// }
-		// bool operator != (const iterator& it) { return !(*this == it); }
+      iterator(): _map(0), _i(0) {}
+      ~iterator() {}
+
+      const HashNode& operator * () const { return _map->_nodes[_i]; }
+      iterator& operator ++ () { ++_i; return (*this); }
+      iterator operator ++ (int) { iterator r = *this; ++_i; return r; }
+      iterator& operator -- () { --_i; return (*this); }
+      iterator operator -- (int) { iterator r = *this; --_i; return r; }
+      bool operator == (const iterator& it) const {
+         return (_map == it._map && _i == it._i); }
+      bool operator != (const iterator& it) const { return !(*this == it); }
 
    private:
-		const HashMap*		_map;
-		size_t				_num;
-		short					_node;
+      iterator(const HashMap* m, size_t i): _map(m), _i(i) {}
+
+      const HashMap*    _map;
+      size_t            _i;
    };
 
    void init(size_t b) {
-      reset(); _numBuckets = b; _buckets = new vector<HashNode>[b]; }
+      reset(); _numBuckets = b; _buckets = new vector<size_t>[b]; }
    void reset() {
       _numBuckets = 0;
       if (_buckets) { delete [] _buckets; _buckets = 0; }
+      _nodes.clear();
    }
+   // only the buckets in use are cleared
    void clear() {
-      for (size_t i = 0; i < _numBuckets; ++i) _buckets[i].clear();
+      for (size_t i = 0; i < _nodes.size(); ++i)
+         _buckets[bucketNum(_nodes[i].first)].clear();
+      _nodes.clear();
    }
    size_t numBuckets() const { return _numBuckets; }
 
-   vector<HashNode>& operator [] (size_t i) { return _buckets[i]; }
-   const vector<HashNode>& operator [](size_t i) const { return _buckets[i]; }
-
-   // TODO: implement these functions
-   //
    // Point to the first valid data
-   iterator begin() const {
-		for(size_t i=0; i<_numBuckets; i++)
-			if(!_buckets[i].empty()) {
-				return iterator(this, i, 0);
-			}
-		return iterator();
-	}
+   iterator begin() const { return iterator(this, 0); }
    // Pass the end
-   iterator end() const {
-		for(size_t i=_numBuckets-1; i>=0; i--)
-			if(!_buckets[i].empty()) {
-				size_t size = _buckets[i].size();
-				return iterator(this, i, size);
-			}
-		return iterator();
-	}
+   iterator end() const { return iterator(this, _nodes.size()); }
    // return true if no valid data
-   bool empty() const {
-		for(size_t i=0; i<_numBuckets; i++)
-			if(!_buckets[i].empty())	return false;
-		return true;
-	}
+   bool empty() const { return _nodes.empty(); }
    // number of valid data
-   size_t size() const {
-		size_t s = 0;
-		for(size_t i=0; i<_numBuckets; i++)		s += _buckets[i].size();
-		return s;
-	}
+   size_t size() const { return _nodes.size(); }
 
    // check if k is in the hash...
    // if yes, return true;
    // else return false;
-   bool check(const HashKey& k) const {
-		size_t num = bucketNum(k);
-		for(size_t i=0; i<_buckets[num].size(); i++)
-			if(_buckets[num][i].first == k)	return true;
-		return false;
-	}
+   bool check(const HashKey& k) const { return (find(k) != _nodes.size()); }
 
    // query if k is in the hash...
    // if yes, replace d with the data in the hash and return true;
    // else return false;
    bool query(const HashKey& k, HashData& d) const {
-		size_t num = bucketNum(k);
-		for(size_t i=0; i<_buckets[num].size(); i++)
-			if(_buckets[num][i].first == k) { d = _buckets[num][i].second; return true; }
-		return false;
-	}
+      size_t i = find(k);
+      if (i == _nodes.size()) return false;
+      d = _nodes[i].second;
+      return true;
+   }
 
    // update the entry in hash that is equal to k (i.e. == return true)
    // if found, update that entry with d and return true;
    // else insert d into hash as a new entry and return false;
-   bool update(const HashKey& k, HashData& d) {
-		size_t num = bucketNum(k);
-		for(size_t i=0; i<_buckets[num].size(); i++)
-			if(_buckets[num][i].first == k) { _buckets[num][i].second = d; return true; }
-		_buckets[num].push_back(HashNode(k, d));
-		return false;
-	}
+   bool update(const HashKey& k, const HashData& d) {
+      size_t i = find(k);
+      if (i != _nodes.size()) { _nodes[i].second = d; return true; }
+      add(k, d);
+      return false;
+   }
    // return true if inserted d successfully (i.e. k is not in the hash)
    // return false is k is already in the hash ==> will not insert
    bool insert(const HashKey& k, const HashData& d) {
-		if(check(k))	return false;
-		size_t num = bucketNum(k);
-		_buckets[num].push_back(HashNode(k, d));
-		return true;
-	}
+      if (check(k)) return false;
+      add(k, d);
+      return true;
+   }
 
    // return true if removed successfully (i.e. k is in the hash)
    // return fasle otherwise (i.e. nothing is removed)
    bool remove(const HashKey& k) {
-		size_t num = bucketNum(k);
-		for(size_t i=0; i<_buckets[num].size(); i++)
-			if(_buckets[num][i].first == k) {
-				_buckets[num].erase(_buckets[num].begin()+i);
-				return true;
-			}	
-		return false;
-	}
+      vector<size_t>& b = _buckets[bucketNum(k)];
+      size_t j = 0;
+      while (j < b.size() && !(_nodes[b[j]].first == k)) ++j;
+      if (j == b.size()) return false;
+      size_t i = b[j], last = _nodes.size() - 1;
+      b[j] = b.back(); b.pop_back();
+      if (i != last) {
+         // move the last entry into i, and tell its bucket
+         vector<size_t>& lb = _buckets[bucketNum(_nodes[last].first)];
+         for (j = 0; lb[j] != last; ++j) ;
+         lb[j] = i;
+         _nodes[i] = _nodes[last];
+      }
+      _nodes.pop_back();
+      return true;
+   }
 
 private:
-   // Do not add any extra data member
+   friend class iterator;
+
    size_t                   _numBuckets;
-   vector<HashNode>*        _buckets;
+   vector<size_t>*          _buckets;  // indices in _nodes
+   vector<HashNode>         _nodes;    // all the entries, back to back
 
    size_t bucketNum(const HashKey& k) const {
       return (k() % _numBuckets); }
+   // the index of k in _nodes, or _nodes.size() if none
+   size_t find(const HashKey& k) const {
+      const vector<size_t>& b = _buckets[bucketNum(k)];
+      for (size_t i = 0; i < b.size(); ++i)
+         if (_nodes[b[i]].first == k) return b[i];
+      return _nodes.size();
+   }
+   void add(const HashKey& k, const HashData& d) {
+      _buckets[bucketNum(k)].push_back(_nodes.size());
+      _nodes.push_back(HashNode(k, d));
+   }
+};
+
+//----------------------------
+// Define FlatHashMap classes
+//----------------------------
+// The same HashKey and the same functions as HashMap, in one array of
+// slots with open addressing: a key is put in the first free slot from
+// its home slot on (linear probing), so a lookup reads neighbouring
+// slots instead of following a pointer to a bucket, and an insert
+// allocates nothing until the map grows.
+//
+// The capacity is a power of 2, and it doubles once the map is 3/4 full;
+// "n" of the constructor or init() is the number of entries expected.
+// The home slot is taken from the high bits of k() times a large odd
+// number (Fibonacci hashing), so keys that only differ in their high
+// bits or are multiples of a power of 2 are still spread out.
+//
+// remove() leaves no tombstone: the entries after the removed one are
+// moved back into it if that is not before their home slots.
+//
+template <class HashKey, class HashData>
+class FlatHashMap
+{
+typedef pair<HashKey, HashData> HashNode;
 
+struct Slot
+{
+   Slot() : _used(false) {}
+   HashNode    _node;
+   bool        _used;
 };
 
+public:
+   FlatHashMap(size_t n = 0) : _size(0), _shift(0) { init(n); }
+   ~FlatHashMap() {}
+
+   // visits the entries in the order of the slots
+   class iterator
+   {
+      friend class FlatHashMap<HashKey, HashData>;
+
+   public:
+      iterator(): _map(0), _i(0) {}
+      ~iterator() {}
+
+      const HashNode& operator * () const { return _map->_slots[_i]._node; }
+      iterator& operator ++ () { _i = _map->next(_i + 1); return (*this); }
+      iterator operator ++ (int) { iterator r = *this; ++(*this); return r; }
+      bool operator == (const iterator& it) const {
+         return (_map == it._map && _i == it._i); }
+      bool operator != (const iterator& it) const { return !(*this == it); }
+
+   private:
+      iterator(const FlatHashMap* m, size_t i): _map(m), _i(i) {}
+
+      const FlatHashMap*   _map;
+      size_t               _i;
+   };
+
+   void init(size_t n) {
+      size_t c = 8;
+      while (c * 3 < n * 4) c *= 2;
+      alloc(c);
+   }
+   void reset() { vector<Slot>().swap(_slots); init(0); }
+   void clear() {
+      for (size_t i = 0; i < _slots.size(); ++i) _slots[i]._used = false;
+      _size = 0;
+   }
+   size_t capacity() const { return _slots.size(); }
+
+   iterator begin() const { return iterator(this, next(0)); }
+   iterator end() const { return iterator(this, _slots.size()); }
+   bool empty() const { return (_size == 0); }
+   size_t size() const { return _size; }
+
+   // check if k is in the hash...
+   bool check(const HashKey& k) const { return (find(k) != _slots.size()); }
+
+   // query if k is in the hash...
+   // if yes, replace d with the data in the hash and return true;
+   // else return false;
+   bool query(const HashKey& k, HashData& d) const {
+      size_t i = find(k);
+      if (i == _slots.size()) return false;
+      d = _slots[i]._node.second;
+      return true;
+   }
+
+   // if k is in the hash, update its data with d and return true;
+   // else insert d into hash as a new entry and return false;
+   bool update(const HashKey& k, const HashData& d) {
+      size_t i = find(k);
+      if (i != _slots.size()) { _slots[i]._node.second = d; return true; }
+      add(k, d);
+      return false;
+   }
+   // return true if inserted d successfully (i.e. k is not in the hash)
+   // return false is k is already in the hash ==> will not insert
+   bool insert(const HashKey& k, const HashData& d) {
+      if (find(k) != _slots.size()) return false;
+      add(k, d);
+      return true;
+   }
+
+   // return true if removed successfully (i.e. k is in the hash)
+   // return false otherwise (i.e. nothing is removed)
+   bool remove(const HashKey& k) {
+      size_t i = find(k);
+      if (i == _slots.size()) return false;
+      size_t mask = _slots.size() - 1;
+      for (size_t j = (i + 1) & mask; _slots[j]._used; j = (j + 1) & mask) {
+         // the entry at j may move to i unless its home is in (i, j]
+         if (((j - home(_slots[j]._node.first)) & mask) < ((j - i) & mask))
+            continue;
+         _slots[i]._node = _slots[j]._node;
+         i = j;
+      }
+      _slots[i]._used = false;
+      --_size;
+      return true;
+   }
+
+private:
+   friend class iterator;
+
+   vector<Slot>   _slots;
+   size_t         _size;
+   unsigned       _shift;  // bits of size_t less those of the capacity
+
+   // empty, with capacity c (a power of 2)
+   void alloc(size_t c) {
+      _slots.assign(c, Slot());
+      _size = 0;
+      _shift = sizeof(size_t) * 8;
+      for (; c > 1; c /= 2) --_shift;
+   }
+   size_t home(const HashKey& k) const {
+      return ((size_t)(k() * (size_t)0x9e3779b97f4a7c15ULL) >> _shift); }
+   // the slot of k, or _slots.size() if none
+   size_t find(const HashKey& k) const {
+      size_t mask = _slots.size() - 1;
+      for (size_t i = home(k); _slots[i]._used; i = (i + 1) & mask)
+         if (_slots[i]._node.first == k) return i;
+      return _slots.size();
+   }
+   // k is known not to be in the hash
+   void add(const HashKey& k, const HashData& d) {
+      if ((_size + 1) * 4 > _slots.size() * 3) grow();
+      size_t mask = _slots.size() - 1;
+      size_t i = home(k);
+      while (_slots[i]._used) i = (i + 1) & mask;
+      _slots[i]._node = HashNode(k, d);
+      _slots[i]._used = true;
+      ++_size;
+   }
+   void grow() {
+      vector<Slot> old;
+      old.swap(_slots);
+      size_t n = _size;
+      alloc(old.size() * 2);
+      size_t mask = _slots.size() - 1;
+      for (size_t j = 0; j < old.size(); ++j) {
+         if (!old[j]._used) continue;
+         size_t i = home(old[j]._node.first);
+         while (_slots[i]._used) i = (i + 1) & mask;
+         _slots[i] = old[j];
+      }
+      _size = n;
+   }
+   // the first used slot from i on, or _slots.size()
+   size_t next(size_t i) const {
+      while (i < _slots.size() && !_slots[i]._used) ++i;
+      return i;
+   }
+};
 
 //---------------------
 // Define Cache classes
@@ -243,49 +362,91 @@ private:
 // private:
 // }; 
 // 
-template <class CacheKey, class CacheData>
+// The cache is set-associative: a key can only be in the "Ways" entries
+// of set k() % (number of sets), and a new key takes an unused entry
+// there or else evicts the least recently used one, as told by the
+// stamp of its last read or write. Hits, misses and evictions are
+// counted until resetStats().
+//
+template <class CacheKey, class CacheData, unsigned Ways = 4>
 class Cache
 {
 typedef pair<CacheKey, CacheData> CacheNode;
 
 public:
-   Cache() : _size(0), _cache(0) {}
-   Cache(size_t s) : _size(0), _cache(0) { init(s); }
+   Cache() : _size(0), _sets(0), _cache(0), _stamp(0), _tick(0) { resetStats(); }
+   Cache(size_t s) : _size(0), _sets(0), _cache(0), _stamp(0), _tick(0) { init(s); }
    ~Cache() { reset(); }
 
    // NO NEED to implement Cache::iterator class
 
-   // TODO: implement these functions
-   //
-   // Initialize _cache with size s
-   void init(size_t s) { reset(); _size = s; _cache = new CacheNode[s]; }
-   void reset() {  _size = 0; if (_cache) { delete [] _cache; _cache = 0; } }
+   // Initialize _cache with size s, rounded up to whole sets
+   void init(size_t s) {
+      reset();
+      _sets = (s + Ways - 1) / Ways;
+      if (_sets == 0) _sets = 1;
+      _size = _sets * Ways;
+      _cache = new CacheNode[_size];
+      _stamp = new size_t[_size]();
+      _tick = 0;
+      resetStats();
+   }
+   void reset() {
+      _size = _sets = 0;
+      if (_cache) { delete [] _cache; _cache = 0; }
+      if (_stamp) { delete [] _stamp; _stamp = 0; }
+   }
 
    size_t size() const { return _size; }
+   size_t hits() const { return _hits; }
+   size_t misses() const { return _misses; }
+   size_t evictions() const { return _evictions; }
+   void resetStats() { _hits = _misses = _evictions = 0; }
 
    CacheNode& operator [] (size_t i) { return _cache[i]; }
    const CacheNode& operator [](size_t i) const { return _cache[i]; }
 
-   // return false if cache miss
-   bool read(const CacheKey& k, CacheData& d) const {
-      size_t i = k() % _size;
-      if (k == _cache[i].first) {
-         d = _cache[i].second;
-         return true;
-      }
-      return false;
+   // return false if cache miss; a hit is now the most recently used
+   bool read(const CacheKey& k, CacheData& d) {
+      size_t i = find(k);
+      if (i == _size) { ++_misses; return false; }
+      ++_hits;
+      _stamp[i] = ++_tick;
+      d = _cache[i].second;
+      return true;
    }
    // If k is already in the Cache, overwrite the CacheData
    void write(const CacheKey& k, const CacheData& d) {
-      size_t i = k() % _size;
-      _cache[i].first = k;
+      if (_size == 0) return;
+      size_t i = find(k);
+      if (i == _size) {
+         size_t first = (k() % _sets) * Ways;
+         i = first;
+         for (size_t j = first + 1; j < first + Ways; ++j)
+            if (_stamp[j] < _stamp[i]) i = j;
+         if (_stamp[i] != 0) ++_evictions;
+         _cache[i].first = k;
+      }
       _cache[i].second = d;
+      _stamp[i] = ++_tick;
    }
 
 private:
-   // Do not add any extra data member
    size_t         _size;
+   size_t         _sets;
    CacheNode*     _cache;
+   size_t*        _stamp;  // by entry; 0 if unused
+   size_t         _tick;
+   size_t         _hits, _misses, _evictions;
+
+   // the entry of k, or _size if none
+   size_t find(const CacheKey& k) const {
+      if (_size == 0) return _size;
+      size_t first = (k() % _sets) * Ways;
+      for (size_t j = first; j < first + Ways; ++j)
+         if (_stamp[j] != 0 && _cache[j].first == k) return j;
+      return _size;
+   }
 };
 
 
@@ -10,6 +10,9 @@
 #define MY_HASH_SET_H
 
 #include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -19,93 +22,242 @@ using namespace std;
 // To use HashSet ADT,
 // the class "Data" should at least overload the "()" and "==" operators.
 //
-// "operator ()" is to generate the hash key (size_t)
-// that will be % by _numBuckets to get the bucket number.
-// ==> See "bucketNum()"
+// "operator ()" is to generate the hash key (size_t); it is mixed
+// again here, so it does not have to spread the bits itself.
 //
 // "operator ==" is to check whether there has already been
 // an equivalent "Data" object in the HashSet.
 // Note that HashSet does not allow equivalent nodes to be inserted
 //
+// The data are kept flat in one array of slots, in the way of Swiss
+// tables: each slot has a control byte, either EMPTY, DELETED or 7 bits
+// of the hash of its data, and the slots are probed 16 at a time by
+// comparing their control bytes at once (with SSE2 if it is there). So
+// a lookup reads a few bytes of control before it compares any data,
+// and mostly compares just the one it is after.
+//
+// The capacity is a power of 2, at least 4; under 16 the slots make one
+// group whose control bytes are padded with EMPTY, so a small set costs
+// little more than its data. The set is rehashed when the used and the
+// deleted slots reach 7/8 of the capacity; "n" of the constructor or
+// init() is the number of data expected.
+//
 template <class Data>
 class HashSet
 {
 public:
-   HashSet(size_t b = 0) : _numBuckets(0), _buckets(0) { if (b != 0) init(b); }
-   ~HashSet() { reset(); }
-
-   // TODO: implement the HashSet<Data>::iterator
-   // o An iterator should be able to go through all the valid Data
-   //   in the Hash
-   // o Functions to be implemented:
-   //   - constructor(s), destructor
-   //   - operator '*': return the HashNode
-   //   - ++/--iterator, iterator++/--
-   //   - operators '=', '==', !="
-   //
+   HashSet(size_t n = 0) : _size(0), _deleted(0) { init(n); }
+   ~HashSet() {}
+
+   // visits the data in the order of the slots
    class iterator
    {
       friend class HashSet<Data>;
 
    public:
+      iterator(): _set(0), _i(0) {}
+      ~iterator() {}
+
+      const Data& operator * () const { return _set->_slots[_i]; }
+      iterator& operator ++ () { _i = _set->next(_i + 1); return (*this); }
+      iterator operator ++ (int) { iterator r = *this; ++(*this); return r; }
+      iterator& operator -- () { _i = _set->prev(_i); return (*this); }
+      iterator operator -- (int) { iterator r = *this; --(*this); return r; }
+      bool operator == (const iterator& it) const {
+         return (_set == it._set && _i == it._i); }
+      bool operator != (const iterator& it) const { return !(*this == it); }
 
    private:
+      iterator(const HashSet* s, size_t i): _set(s), _i(i) {}
+
+      const HashSet*    _set;
+      size_t            _i;
    };
 
-   void init(size_t b) { _numBuckets = b; _buckets = new vector<Data>[b]; }
+   void init(size_t n) {
+      size_t c = MIN_CAP;
+      while (c * 7 < n * 8) c *= 2;
+      alloc(c);
+   }
    void reset() {
-      _numBuckets = 0;
-      if (_buckets) { delete [] _buckets; _buckets = 0; }
+      vector<Data>().swap(_slots); vector<signed char>().swap(_ctrl);
+      init(0);
    }
    void clear() {
-      for (size_t i = 0; i < _numBuckets; ++i) _buckets[i].clear();
+      _ctrl.assign(_ctrl.size(), EMPTY);
+      _size = _deleted = 0;
    }
-   size_t numBuckets() const { return _numBuckets; }
-
-   vector<Data>& operator [] (size_t i) { return _buckets[i]; }
-   const vector<Data>& operator [](size_t i) const { return _buckets[i]; }
+   size_t capacity() const { return _slots.size(); }
 
-   // TODO: implement these functions
-   //
    // Point to the first valid data
-   iterator begin() const { return iterator(); }
+   iterator begin() const { return iterator(this, next(0)); }
    // Pass the end
-   iterator end() const { return iterator(); }
+   iterator end() const { return iterator(this, _slots.size()); }
    // return true if no valid data
-   bool empty() const { return true; }
+   bool empty() const { return (_size == 0); }
    // number of valid data
-   size_t size() const { size_t s = 0; return s; }
+   size_t size() const { return _size; }
 
    // check if d is in the hash...
    // if yes, return true;
    // else return false;
-   bool check(const Data& d) const { return false; }
+   bool check(const Data& d) const { return (find(d) != _slots.size()); }
 
    // query if d is in the hash...
    // if yes, replace d with the data in the hash and return true;
    // else return false;
-   bool query(Data& d) const { return false; }
+   bool query(Data& d) const {
+      size_t i = find(d);
+      if (i == _slots.size()) return false;
+      d = _slots[i];
+      return true;
+   }
 
    // update the entry in hash that is equal to d (i.e. == return true)
    // if found, update that entry with d and return true;
    // else insert d into hash as a new entry and return false;
-   bool update(const Data& d) { return false; }
+   bool update(const Data& d) {
+      size_t i = find(d);
+      if (i != _slots.size()) { _slots[i] = d; return true; }
+      add(d);
+      return false;
+   }
 
    // return true if inserted successfully (i.e. d is not in the hash)
    // return false is d is already in the hash ==> will not insert
-   bool insert(const Data& d) { return true; }
+   bool insert(const Data& d) {
+      if (find(d) != _slots.size()) return false;
+      add(d);
+      return true;
+   }
 
    // return true if removed successfully (i.e. d is in the hash)
    // return fasle otherwise (i.e. nothing is removed)
-   bool remove(const Data& d) { return false; }
+   bool remove(const Data& d) {
+      size_t i = find(d);
+      if (i == _slots.size()) return false;
+      // a lookup stops at a group with an empty slot, so none has gone
+      // past this group if it has one; else the slot is marked DELETED
+      if (matchEmpty(&_ctrl[i & ~(size_t)(GROUP - 1)])) _ctrl[i] = EMPTY;
+      else { _ctrl[i] = DELETED; ++_deleted; }
+      --_size;
+      return true;
+   }
 
 private:
-   // Do not add any extra data member
-   size_t            _numBuckets;
-   vector<Data>*     _buckets;
+   friend class iterator;
 
-   size_t bucketNum(const Data& d) const {
-      return (d() % _numBuckets); }
+   enum { GROUP = 16, MIN_CAP = 4, EMPTY = -128, DELETED = -2 };
+
+   vector<Data>         _slots;
+   vector<signed char>  _ctrl;     // by slot, and at least GROUP;
+                                   // EMPTY, DELETED or 7 hash bits
+   size_t               _size;
+   size_t               _deleted;  // number of DELETED slots
+
+   // empty, with capacity c (a power of 2, at least MIN_CAP)
+   void alloc(size_t c) {
+      _slots.assign(c, Data());
+      _ctrl.assign(c < GROUP? (size_t)GROUP: c, EMPTY);
+      _size = _deleted = 0;
+   }
+   size_t groupMask() const {
+      return (_slots.size() < GROUP? 0: _slots.size() / GROUP - 1); }
+   // the 64-bit finalizer of MurmurHash3
+   static size_t hash(const Data& d) {
+      unsigned long long h = d();
+      h ^= h >> 33;  h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return (size_t)h;
+   }
+
+   // bit j of the results is for slot j of the group at g
+#ifdef __SSE2__
+   static unsigned match(const signed char* g, signed char c) {
+      __m128i v = _mm_loadu_si128((const __m128i*)g);
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+   }
+   // EMPTY or DELETED, the control bytes with the sign bit
+   static unsigned matchFree(const signed char* g) {
+      return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)g));
+   }
+#else
+   static unsigned match(const signed char* g, signed char c) {
+      unsigned m = 0;
+      for (unsigned j = 0; j < GROUP; ++j) m |= (unsigned)(g[j] == c) << j;
+      return m;
+   }
+   static unsigned matchFree(const signed char* g) {
+      unsigned m = 0;
+      for (unsigned j = 0; j < GROUP; ++j) m |= (unsigned)(g[j] < 0) << j;
+      return m;
+   }
+#endif
+   static unsigned matchEmpty(const signed char* g) { return match(g, EMPTY); }
+   // m != 0
+   static unsigned lowBit(unsigned m) {
+#ifdef __GNUC__
+      return __builtin_ctz(m);
+#else
+      unsigned j = 0;
+      for (; !(m & 1); m >>= 1) ++j;
+      return j;
+#endif
+   }
+
+   // the groups are probed from the one of the hash on, by 1, 2, 3, ...
+   // groups further each time, which visits all of them
+   size_t find(const Data& d) const {
+      size_t h = hash(d), mask = groupMask();
+      signed char h2 = h & 0x7f;
+      for (size_t g = (h >> 7) & mask, step = 1; ; g = (g + step++) & mask) {
+         const signed char* ctrl = &_ctrl[g * GROUP];
+         for (unsigned m = match(ctrl, h2); m; m &= m - 1) {
+            size_t i = g * GROUP + lowBit(m);
+            if (_slots[i] == d) return i;
+         }
+         if (matchEmpty(ctrl)) return _slots.size();
+      }
+   }
+   // d is known not to be in the hash
+   void add(const Data& d) {
+      if ((_size + _deleted + 1) * 8 > _slots.size() * 7) rehash();
+      size_t h = hash(d), mask = groupMask();
+      size_t g = (h >> 7) & mask;
+      // not the padding of a small set
+      unsigned slots = (_slots.size() < GROUP? (1u << _slots.size()) - 1: ~0u);
+      unsigned m;
+      for (size_t step = 1; !(m = matchFree(&_ctrl[g * GROUP]) & slots); g = (g + step++) & mask) ;
+      size_t i = g * GROUP + lowBit(m);
+      if (_ctrl[i] == DELETED) --_deleted;
+      _ctrl[i] = h & 0x7f;
+      _slots[i] = d;
+      ++_size;
+   }
+   // doubles the capacity if over 7/16 of it is in use; else the same
+   // capacity, only without the DELETED slots
+   void rehash() {
+      vector<Data> old;
+      vector<signed char> oldCtrl;
+      old.swap(_slots); oldCtrl.swap(_ctrl);
+      size_t c = old.size();
+      if ((_size + 1) * 16 > c * 7) c *= 2;
+      alloc(c);
+      for (size_t i = 0; i < old.size(); ++i)
+         if (oldCtrl[i] >= 0) add(old[i]);
+   }
+   // the first used slot from i on, or _slots.size()
+   size_t next(size_t i) const {
+      while (i < _slots.size() && _ctrl[i] < 0) ++i;
+      return i;
+   }
+   // the last used slot before i, or i if none
+   size_t prev(size_t i) const {
+      for (size_t j = i; j > 0; --j)
+         if (_ctrl[j - 1] >= 0) return j - 1;
+      return i;
+   }
 };
 
 #endif // MY_HASH_SET_H
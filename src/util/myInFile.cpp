@@ -0,0 +1,149 @@
+/****************************************************************************
+  FileName     [ myInFile.cpp ]
+  PackageName  [ util ]
+  Synopsis     [ Define read-only memory-mapped input file ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include "myInFile.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Static functions
+//----------------------------------------------------------------------
+static const size_t STREAM_BUF_SIZE = 1 << 20;
+
+// compressed files are recognized by their magic numbers
+static const char*
+decompressor(const char* p, size_t n)
+{
+   if (n >= 2 && memcmp(p, "\x1f\x8b", 2) == 0) return "gzip";
+   if (n >= 6 && memcmp(p, "\xfd" "7zXZ\0", 6) == 0) return "xz";
+   return 0;
+}
+
+//----------------------------------------------------------------------
+//    class InFile member functions
+//----------------------------------------------------------------------
+bool
+InFile::open(const string& fileName)
+{
+   close();
+   _fd = ::open(fileName.c_str(), O_RDONLY);
+   if (_fd < 0) return false;
+   struct stat st;
+   if (fstat(_fd, &st) != 0 || !S_ISREG(st.st_mode)) { close(); return false; }
+   if (st.st_size == 0) return true;  // nothing to map; begin() == end()
+
+   void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+   if (p == MAP_FAILED) { close(); return false; }
+   const char* prog = decompressor((const char*)p, st.st_size);
+   if (prog) {
+      munmap(p, st.st_size);
+      return spawn(prog);
+   }
+   madvise(p, st.st_size, MADV_SEQUENTIAL);
+   _begin = (char*)p;
+   _end = _begin + st.st_size;
+   return true;
+}
+
+void
+InFile::close()
+{
+   if (_buf) delete [] _buf;
+   else if (_begin) munmap(_begin, _end - _begin);
+   if (_fd >= 0) ::close(_fd);
+   // a decompressor that is not drained ends on SIGPIPE
+   if (_pid >= 0) waitpid(_pid, 0, 0);
+   _fd = _pid = -1;
+   _failed = false;
+   _eof = true;
+   _buf = _begin = _end = 0;
+   _bufSize = 0;
+}
+
+// run "prog -dc" with the file as its stdin and read its stdout;
+// fail if it produces nothing and does not exit normally
+// (e.g. prog is not installed)
+bool
+InFile::spawn(const char* prog)
+{
+   int fds[2];
+   if (pipe(fds) != 0) { close(); return false; }
+   pid_t pid = fork();
+   if (pid < 0) {
+      ::close(fds[0]); ::close(fds[1]);
+      close(); return false;
+   }
+   if (pid == 0) {
+      signal(SIGPIPE, SIG_DFL);
+      dup2(_fd, 0);
+      dup2(fds[1], 1);
+      ::close(fds[0]); ::close(fds[1]); ::close(_fd);
+      execlp(prog, prog, "-dc", (char*)0);
+      _exit(127);
+   }
+   ::close(fds[1]);
+   ::close(_fd);
+   _fd = fds[0];
+   _pid = pid;
+   _eof = false;
+   _bufSize = STREAM_BUF_SIZE;
+   _buf = _begin = _end = new char[_bufSize];
+
+   const char* p = _begin;
+   fill(p, 1);
+   if (_begin == _end && _failed) { close(); return false; }
+   return true;
+}
+
+// keep [p, _end) at the front of the buffer and read behind it;
+// the buffer grows if a line does not fit
+void
+InFile::fill(const char*& p, size_t n)
+{
+   size_t keep = _end - p;
+   memmove(_buf, p, keep);
+   _begin = _buf;
+   _end = _buf + keep;
+   p = _buf;
+   while (!_eof) {
+      if (_end == _buf + _bufSize) {
+         char* temp = new char[_bufSize * 2];
+         memcpy(temp, _buf, _bufSize);
+         delete [] _buf;
+         _end = temp + _bufSize;
+         _buf = _begin = temp;
+         _bufSize *= 2;
+         p = _buf;
+      }
+      ssize_t r = ::read(_fd, _end, _buf + _bufSize - _end);
+      if (r < 0 && errno == EINTR) continue;
+      if (r <= 0) { reap(); break; }
+      char* from = _end;
+      _end += r;
+      if (n? (size_t)(_end - p) >= n: memchr(from, '\n', r) != 0) break;
+   }
+}
+
+// the content has ended; collect the decompressor
+void
+InFile::reap()
+{
+   int status = 0;
+   _eof = true;
+   if (_pid < 0) return;
+   _failed = (waitpid(_pid, &status, 0) != _pid || !WIFEXITED(status)
+              || WEXITSTATUS(status) != 0);
+   _pid = -1;
+}
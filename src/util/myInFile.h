@@ -0,0 +1,75 @@
+/****************************************************************************
+  FileName     [ myInFile.h ]
+  PackageName  [ util ]
+  Synopsis     [ Define read-only memory-mapped input file ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_IN_FILE_H
+#define MY_IN_FILE_H
+
+#include <string>
+#include <cstring>
+#include <sys/types.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Define InFile class
+//----------------------------------------------------------------------
+// The whole file is mapped into memory so that parsers can scan the
+// characters in place between [begin(), end()).
+// Note that the content is NOT null-terminated.
+//
+// A gzip or xz compressed file is decompressed on the fly by the
+// "gzip -dc" or "xz -dc" program instead. Then [begin(), end()) is
+// only a window of the content, and a parser has to call refill()
+// before it scans a line (or n characters). For a mapped file,
+// refill() does nothing, so a parser can always call it.
+//
+class InFile
+{
+public:
+   InFile() : _fd(-1), _pid(-1), _failed(false), _eof(true),
+              _buf(0), _bufSize(0), _begin(0), _end(0) {}
+   ~InFile() { close(); }
+
+   bool open(const string& fileName);
+   void close();
+   bool isOpen() const { return (_fd >= 0 || _buf); }
+   bool isStream() const { return (_buf != 0); }
+
+   const char* begin() const { return _begin; }
+   const char* end() const { return _end; }
+   size_t size() const { return (_end - _begin); }
+
+   // make [p, end) hold a whole line (n == 0) or n characters,
+   // unless the content ends first; p and end move with the window
+   void refill(const char*& p, const char*& end, size_t n = 0) {
+      if (_eof) return;
+      if (n? (size_t)(_end - p) >= n: memchr(p, '\n', _end - p) != 0)
+         return;
+      fill(p, n);
+      end = _end;
+   }
+
+private:
+   int            _fd;       // the file, or the pipe of a decompressor
+   pid_t          _pid;      // the decompressor
+   bool           _failed;   // the decompressor did not exit normally
+   bool           _eof;
+   char*          _buf;      // window of a stream; 0 if mapped
+   size_t         _bufSize;
+   char*          _begin;
+   char*          _end;
+
+   bool spawn(const char* prog);
+   void fill(const char*& p, size_t n);
+   void reap();
+
+   // not copyable; the mapping belongs to one object
+   InFile(const InFile&);
+   InFile& operator = (const InFile&);
+};
+
+#endif // MY_IN_FILE_H
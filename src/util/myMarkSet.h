@@ -0,0 +1,54 @@
+/****************************************************************************
+  FileName     [ myMarkSet.h ]
+  PackageName  [ util ]
+  Synopsis     [ Define the marks of one traversal ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2014-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_MARK_SET_H
+#define MY_MARK_SET_H
+
+#include <vector>
+
+using namespace std;
+
+//---------------------
+// Define MarkSet class
+//---------------------
+// The IDs marked by one traversal, one bit each. A traversal owns its
+// MarkSet, so traversals can be nested, and ones on different threads
+// can run at the same time as long as each thread has its own.
+//
+// The bits of a million IDs take 128KB and mostly stay in the cache,
+// which is what a DFS with its marks outside of the gates needs; clear()
+// costs n/8 bytes of memset, next to nothing for a pass over n gates.
+// The set grows to cover any ID that is marked, but it had better be
+// constructed with the number of IDs.
+//
+class MarkSet
+{
+public:
+   MarkSet(size_t n = 0) : _bits((n + W - 1) / W, 0) {}
+   ~MarkSet() {}
+
+   void clear() { _bits.assign(_bits.size(), 0); }
+   bool isMarked(size_t i) const {
+      return (i / W < _bits.size() && (_bits[i / W] >> (i % W) & 1)); }
+   void mark(size_t i) {
+      if (i / W >= _bits.size()) _bits.resize(i / W + 1, 0);
+      _bits[i / W] |= (size_t)1 << (i % W);
+   }
+   // return false if "i" has already been marked
+   bool markNew(size_t i) {
+      if (isMarked(i)) return false;
+      mark(i);
+      return true;
+   }
+
+private:
+   static const size_t W = sizeof(size_t) * 8;
+   vector<size_t>    _bits;
+};
+
+#endif // MY_MARK_SET_H
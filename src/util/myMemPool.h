@@ -0,0 +1,86 @@
+/****************************************************************************
+  FileName     [ myMemPool.h ]
+  PackageName  [ util ]
+  Synopsis     [ Define a pool of fixed-size memory blocks ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2014-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_MEM_POOL_H
+#define MY_MEM_POOL_H
+
+#include <vector>
+#include <cstdlib>
+#include <cassert>
+
+using namespace std;
+
+//---------------------
+// Define MemPool class
+//---------------------
+// Blocks of "blockSize" bytes are cut out of slabs of "slabBlocks"
+// blocks each. A freed block goes to a free list and is handed out
+// again by the next alloc(); reset() returns all the slabs at once,
+// without visiting the blocks.
+//
+// The objects placed in the blocks are not destructed by reset(), so
+// they should not own any memory outside of the pool by then.
+//
+class MemPool
+{
+public:
+   MemPool(size_t blockSize, size_t slabBlocks = 4096)
+      : _blockSize(align(blockSize)), _slabBlocks(slabBlocks),
+        _next(0), _end(0), _free(0) {}
+   ~MemPool() { reset(); }
+
+   void* alloc() {
+      if (_free != 0) {
+         void* p = _free;
+         _free = *(void**)_free;
+         return p;
+      }
+      if (_next == _end) newSlab();
+      void* p = _next;
+      _next += _blockSize;
+      return p;
+   }
+   void free(void* p) {
+      if (p == 0) return;
+      *(void**)p = _free;
+      _free = p;
+   }
+   void reset() {
+      for (size_t i = 0, n = _slabs.size(); i < n; ++i)
+         ::free(_slabs[i]);
+      _slabs.clear();
+      _next = _end = 0;
+      _free = 0;
+   }
+
+   size_t blockSize() const { return _blockSize; }
+   size_t numSlabs() const { return _slabs.size(); }
+
+private:
+   size_t            _blockSize;
+   size_t            _slabBlocks;
+   char*             _next;      // first unused block of the last slab
+   char*             _end;
+   void*             _free;      // freed blocks, linked through their first word
+   vector<char*>     _slabs;
+
+   static size_t align(size_t s) {
+      const size_t a = sizeof(void*) > sizeof(double)? sizeof(void*): sizeof(double);
+      if (s < sizeof(void*)) s = sizeof(void*);
+      return (s + a - 1) / a * a;
+   }
+   void newSlab() {
+      char* s = (char*)malloc(_blockSize * _slabBlocks);
+      assert(s != 0);
+      _slabs.push_back(s);
+      _next = s;
+      _end = s + _blockSize * _slabBlocks;
+   }
+};
+
+#endif // MY_MEM_POOL_H
@@ -0,0 +1,101 @@
+/****************************************************************************
+  FileName     [ myOutBuf.h ]
+  PackageName  [ util ]
+  Synopsis     [ Define buffered, flush-free output writer ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_OUT_BUF_H
+#define MY_OUT_BUF_H
+
+#include <iostream>
+#include <string>
+#include <cstring>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Define OutBuf class
+//----------------------------------------------------------------------
+// Characters are collected in one large user-space buffer and handed to
+// the stream only when the buffer is full or the OutBuf is destroyed.
+// Nothing is flushed per line (i.e. never use "endl" through it).
+//
+class OutBuf
+{
+public:
+   OutBuf(ostream& os, size_t s = (1 << 20))
+      : _os(os), _size(s < 64? 64: s) {
+      _buf = new char[_size]; _cur = _buf; }
+   ~OutBuf() { flush(); delete [] _buf; }
+
+   // write out whatever is buffered; the stream is not flushed
+   void flush() {
+      if (_cur != _buf) _os.write(_buf, _cur - _buf);
+      _cur = _buf;
+   }
+
+   OutBuf& put(char c) {
+      if (_cur == _buf + _size) flush();
+      *_cur++ = c;
+      return *this;
+   }
+   OutBuf& put(const char* s, size_t n) {
+      if (n > _size) { flush(); _os.write(s, n); return *this; }
+      reserve(n);
+      memcpy(_cur, s, n); _cur += n;
+      return *this;
+   }
+   OutBuf& put(const char* s) { return put(s, strlen(s)); }
+   OutBuf& put(const string& s) { return put(s.data(), s.size()); }
+
+   // decimal
+   OutBuf& putUInt(unsigned n) {
+      char tmp[10];
+      char* p = tmp + 10;
+      do { *--p = '0' + n % 10; n /= 10; } while (n);
+      return put(p, tmp + 10 - p);
+   }
+   // binary AIGER: 7 bits per byte, LSB first, MSB set if more follow
+   OutBuf& putVarUInt(unsigned n) {
+      reserve(5);
+      while (n & ~0x7f) { *_cur++ = (char)((n & 0x7f) | 0x80); n >>= 7; }
+      *_cur++ = (char)n;
+      return *this;
+   }
+   // the lowest n (<= 32) bits of w as '0'/'1' characters, LSB first;
+   // 8 characters are copied at a time from a table
+   OutBuf& putBits(unsigned w, unsigned n) {
+      static const BitTable table;
+      reserve(n + 8);
+      for (unsigned i = 0; i < n; i += 8, w >>= 8)
+         memcpy(_cur + i, table._str[w & 0xff], 8);
+      _cur += n;
+      return *this;
+   }
+
+private:
+   struct BitTable
+   {
+      BitTable() {
+         for (unsigned i = 0; i < 256; ++i)
+            for (unsigned j = 0; j < 8; ++j)
+               _str[i][j] = ((i >> j) & 1)? '1': '0';
+      }
+      char _str[256][8];
+   };
+
+   ostream&       _os;
+   size_t         _size;
+   char*          _buf;
+   char*          _cur;
+
+   // make room for at least n more characters
+   void reserve(size_t n) { if (_cur + n > _buf + _size) flush(); }
+
+   // not copyable; one buffer per stream
+   OutBuf(const OutBuf&);
+   OutBuf& operator = (const OutBuf&);
+};
+
+#endif // MY_OUT_BUF_H
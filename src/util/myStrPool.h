@@ -0,0 +1,142 @@
+/****************************************************************************
+  FileName     [ myStrPool.h ]
+  PackageName  [ util ]
+  Synopsis     [ Define a pool of names indexed by ID ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2014-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef MY_STR_POOL_H
+#define MY_STR_POOL_H
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+//---------------------
+// Define StrRef class
+//---------------------
+// A read-only view of characters kept somewhere else (e.g. in a StrPool);
+// it is only good as long as they are.
+//
+class StrRef
+{
+public:
+   StrRef() : _s(""), _n(0) {}
+   StrRef(const char* s, size_t n) : _s(s), _n(n) {}
+   StrRef(const string& s) : _s(s.c_str()), _n(s.size()) {}
+
+   const char* data() const { return _s; }
+   size_t size() const { return _n; }
+   bool empty() const { return (_n == 0); }
+   string str() const { return string(_s, _n); }
+
+   bool operator == (const StrRef& r) const {
+      return (_n == r._n && memcmp(_s, r._s, _n) == 0); }
+   bool operator != (const StrRef& r) const { return !(*this == r); }
+
+   friend ostream& operator << (ostream& os, const StrRef& r) {
+      return os.write(r._s, r._n); }
+
+private:
+   const char*    _s;
+   size_t         _n;
+};
+
+//----------------------
+// Define StrPool class
+//----------------------
+// At most one name per ID. The names are stored back to back in one
+// array, each ended by '\0' (so data() of the returned StrRef is also a
+// C string), and found through a table of offsets by ID; no string is
+// allocated per name.
+//
+// find() goes the other way, through a hash table chained by ID. IDs may
+// share a name; find(name, id) gives the next one after "id".
+//
+class StrPool
+{
+public:
+   enum { NO_ID = 0xffffffffu };
+
+   StrPool() {}
+   ~StrPool() {}
+
+   void reserve(size_t ids, size_t chars) {
+      _ofs.reserve(ids); _len.reserve(ids); _next.reserve(ids);
+      _chars.reserve(chars);
+   }
+   void clear() {
+      _chars.clear(); _ofs.clear(); _len.clear(); _next.clear();
+      _heads.clear(); _ids.clear();
+   }
+
+   // number of names
+   size_t size() const { return _ids.size(); }
+   // the ID of the i-th name inserted
+   unsigned id(size_t i) const { return _ids[i]; }
+
+   bool has(unsigned id) const { return (id < _ofs.size() && _ofs[id] != 0); }
+   StrRef operator [] (unsigned id) const {
+      if (!has(id)) return StrRef();
+      return StrRef(&_chars[_ofs[id] - 1], _len[id]);
+   }
+
+   // return false if "id" already has a name
+   bool insert(unsigned id, const StrRef& name) {
+      if (has(id)) return false;
+      if (id >= _ofs.size()) {
+         _ofs.resize(id + 1, 0); _len.resize(id + 1, 0);
+         _next.resize(id + 1, NO_ID);
+      }
+      _ofs[id] = _chars.size() + 1;
+      _len[id] = name.size();
+      _chars.insert(_chars.end(), name.data(), name.data() + name.size());
+      _chars.push_back('\0');
+      _ids.push_back(id);
+      if (_ids.size() > _heads.size()) rehash();
+      else link(id);
+      return true;
+   }
+
+   // the first ID named "name" after "id" (in no particular order),
+   // or NO_ID
+   unsigned find(const StrRef& name, unsigned id = NO_ID) const {
+      if (_heads.empty()) return NO_ID;
+      id = (id == NO_ID? _heads[hash(name) & (_heads.size() - 1)]: _next[id]);
+      for (; id != NO_ID; id = _next[id])
+         if ((*this)[id] == name) return id;
+      return NO_ID;
+   }
+
+private:
+   vector<char>      _chars;
+   vector<unsigned>  _ofs;    // by ID; offset in _chars + 1, or 0 if no name
+   vector<unsigned>  _len;    // by ID
+   vector<unsigned>  _next;   // by ID; next ID in the same bucket
+   vector<unsigned>  _heads;  // first ID of each bucket; power of 2 buckets
+   vector<unsigned>  _ids;    // in the order inserted
+
+   // FNV-1a
+   static size_t hash(const StrRef& s) {
+      size_t h = 2166136261u;
+      for (size_t i = 0; i < s.size(); ++i)
+         h = (h ^ (unsigned char)s.data()[i]) * 16777619u;
+      return h;
+   }
+   void link(unsigned id) {
+      unsigned& head = _heads[hash((*this)[id]) & (_heads.size() - 1)];
+      _next[id] = head;
+      head = id;
+   }
+   void rehash() {
+      size_t n = (_heads.empty()? 64: _heads.size() * 2);
+      _heads.assign(n, NO_ID);
+      for (size_t i = 0; i < _ids.size(); ++i) link(_ids[i]);
+   }
+};
+
+#endif // MY_STR_POOL_H
@@ -0,0 +1,73 @@
+/****************************************************************************
+  FileName     [ myThread.h ]
+  PackageName  [ util ]
+  Synopsis     [ Run a function on several threads ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2007-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+#ifndef MY_THREAD_H
+#define MY_THREAD_H
+
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+//    Fork-join helpers
+//----------------------------------------------------------------------
+// runTasks(f, arg, n) calls f(arg, k, n) for every k in [0, n), each on
+// its own thread (task 0 runs on the calling thread), and returns when
+// all of them are done. If a thread cannot be created, that task runs
+// on the calling thread instead, so the result never depends on it.
+//
+typedef void (*TaskFunc)(void* arg, unsigned task, unsigned nTasks);
+
+struct TaskArg
+{
+   TaskFunc       _func;
+   void*          _arg;
+   unsigned       _task;
+   unsigned       _nTasks;
+};
+
+static inline void*
+taskEntry(void* p)
+{
+   TaskArg* t = (TaskArg*)p;
+   t->_func(t->_arg, t->_task, t->_nTasks);
+   return 0;
+}
+
+static inline void
+runTasks(TaskFunc func, void* arg, unsigned nTasks)
+{
+   vector<TaskArg> args(nTasks);
+   vector<pthread_t> threads(nTasks);
+   vector<bool> started(nTasks, false);
+   for (unsigned k = 0; k < nTasks; ++k) {
+      TaskArg t = { func, arg, k, nTasks };
+      args[k] = t;
+   }
+   for (unsigned k = 1; k < nTasks; ++k)
+      started[k] = (pthread_create(&threads[k], 0, taskEntry, &args[k]) == 0);
+   func(arg, 0, nTasks);
+   for (unsigned k = 1; k < nTasks; ++k) {
+      if (started[k]) pthread_join(threads[k], 0);
+      else func(arg, k, nTasks);
+   }
+}
+
+// [begin, end) of the k-th of n equal slices of [0, size)
+static inline size_t
+taskBegin(size_t size, unsigned k, unsigned n) { return size * k / n; }
+
+static inline unsigned
+numCores()
+{
+   long n = sysconf(_SC_NPROCESSORS_ONLN);
+   return (n > 1)? (unsigned)n: 1;
+}
+
+#endif // MY_THREAD_H